@@ -0,0 +1,135 @@
+/*
+ * Copyright 2020 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+/* Time unformatted XML serialization of the given files, comparing the
+ * original crm_xml_dump() path (as used for messages before
+ * pcmk__xml_serialize() was added) against pcmk__xml_serialize() with a new
+ * buffer each time and with a reused buffer.
+ */
+
+#include <crm_internal.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <crm/crm.h>
+#include <crm/common/xml.h>
+#include <crm/common/xml_internal.h>
+
+static double
+elapsed_usec(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e6
+           + (now.tv_nsec - start->tv_nsec) / 1e3;
+}
+
+// Serialize as pcmk__ipc_prepare_iov() did before pcmk__xml_serialize()
+static char *
+serialize_old(xmlNode *xml, size_t *len)
+{
+    char *buffer = NULL;
+    int offset = 0;
+    int max = 0;
+
+    crm_xml_dump(xml, 0, &buffer, &offset, &max, 0);
+    *len = (buffer == NULL)? 0 : strlen(buffer);
+    return buffer;
+}
+
+static int
+bench_file(const char *filename, long iterations)
+{
+    xmlNode *xml = filename2xml(filename);
+    pcmk__xml_buf_t reused = { NULL, 0, 0 };
+    struct timespec start;
+    double old_usec, new_usec, reused_usec;
+    char *old_text = NULL;
+    char *new_text = NULL;
+    const char *base = strrchr(filename, '/');
+    size_t len = 0;
+
+    if (xml == NULL) {
+        fprintf(stderr, "Could not parse %s\n", filename);
+        return 1;
+    }
+
+    // Both paths must produce the same text for the timings to be comparable
+    old_text = serialize_old(xml, &len);
+    new_text = dump_xml_unformatted(xml);
+    if (safe_str_neq(old_text, new_text)) {
+        fprintf(stderr, "Serializations of %s differ\n", filename);
+        free(old_text);
+        free(new_text);
+        free_xml(xml);
+        return 1;
+    }
+    free(old_text);
+    free(new_text);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < iterations; i++) {
+        free(serialize_old(xml, &len));
+    }
+    old_usec = elapsed_usec(&start) / iterations;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < iterations; i++) {
+        pcmk__xml_buf_t buf = { NULL, 0, 0 };
+
+        pcmk__xml_serialize(xml, &buf);
+        free(pcmk__xml_buf_steal(&buf));
+    }
+    new_usec = elapsed_usec(&start) / iterations;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < iterations; i++) {
+        pcmk__xml_serialize(xml, &reused);
+    }
+    reused_usec = elapsed_usec(&start) / iterations;
+    free(reused.str);
+
+    printf("%-50s %10lu %10.1f %10.1f %10.1f\n",
+           (base == NULL)? filename : (base + 1), (unsigned long) len,
+           old_usec, new_usec, reused_usec);
+    free_xml(xml);
+    return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    long iterations = 0;
+    int rc = 0;
+
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <iterations> <file.xml>...\n", argv[0]);
+        return CRM_EX_USAGE;
+    }
+    iterations = strtol(argv[1], NULL, 10);
+    if (iterations <= 0) {
+        fprintf(stderr, "Invalid iteration count: %s\n", argv[1]);
+        return CRM_EX_USAGE;
+    }
+
+    crm_log_cli_init("xmlbench");
+    printf("%-50s %10s %10s %10s %10s\n",
+           "input", "bytes", "old usec", "new usec", "reused");
+    for (int lpc = 2; lpc < argc; lpc++) {
+        if (bench_file(argv[lpc], iterations) != 0) {
+            rc = CRM_EX_ERROR;
+        }
+    }
+    crm_xml_cleanup();
+    return rc;
+}
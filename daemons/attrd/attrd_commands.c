@@ -45,6 +45,12 @@
 int last_cib_op_done = 0;
 GHashTable *attributes = NULL;
 
+/* Writes of attributes due within this window are coalesced into a single
+ * CIB request (0 to disable)
+ */
+static guint write_batch_ms = 0;
+static mainloop_timer_t *write_batch_timer = NULL;
+
 void write_attribute(attribute_t *a, bool ignore_delay);
 void write_or_elect_attribute(attribute_t *a);
 void attrd_current_only_attribute_update(crm_node_t *peer, xmlNode *xml);
@@ -61,6 +67,80 @@ send_attrd_message(crm_node_t * node, xmlNode * data)
     return send_cluster_message(node, crm_msg_attrd, data, TRUE);
 }
 
+// Attribute name -> whether to ignore dampening when batch is written
+static GHashTable *write_batch = NULL;
+
+static void write_batched_attributes(void);
+
+static gboolean
+write_batch_timer_cb(gpointer data)
+{
+    write_batched_attributes();
+    return FALSE;
+}
+
+/*!
+ * \internal
+ * \brief Initialize coalescing of CIB writes, if enabled
+ */
+void
+attrd_init_write_batch(void)
+{
+    const char *value = pcmk__env_option("attrd_write_batch");
+
+    if (value != NULL) {
+        long long ms = crm_parse_ll(value, "0");
+
+        if ((ms > 0) && (ms <= 10000)) {
+            write_batch_ms = (guint) ms;
+        } else if (ms != 0) {
+            crm_warn("Ignoring invalid value '%s' for PCMK_attrd_write_batch "
+                     "(must be 0-10000 milliseconds)", value);
+        }
+    }
+
+    if (write_batch_ms > 0) {
+        crm_info("Coalescing attribute writes due within %ums", write_batch_ms);
+        write_batch = g_hash_table_new_full(crm_str_hash, g_str_equal, free,
+                                            NULL);
+        write_batch_timer = mainloop_timer_add("attrd-write-batch",
+                                               write_batch_ms, FALSE,
+                                               write_batch_timer_cb, NULL);
+    }
+}
+
+void
+attrd_free_write_batch(void)
+{
+    if (write_batch_timer != NULL) {
+        mainloop_timer_del(write_batch_timer);
+        write_batch_timer = NULL;
+    }
+    if (write_batch != NULL) {
+        g_hash_table_destroy(write_batch);
+        write_batch = NULL;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Drop any batched attribute writes without sending them
+ *
+ * \note This is used when the local node is no longer the writer, since the
+ *       new writer will write out all attributes when it wins.
+ */
+void
+attrd_clear_write_batch(void)
+{
+    if ((write_batch != NULL) && (g_hash_table_size(write_batch) > 0)) {
+        crm_info("Discarding %u batched attribute write%s",
+                 g_hash_table_size(write_batch),
+                 pcmk__plural_s(g_hash_table_size(write_batch)));
+        mainloop_timer_stop(write_batch_timer);
+        g_hash_table_remove_all(write_batch);
+    }
+}
+
 static gboolean
 attribute_timer_cb(gpointer data)
 {
@@ -1064,6 +1144,21 @@ attrd_cib_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void *u
     }
 }
 
+static void
+attrd_cib_batch_callback(xmlNode *msg, int call_id, int rc, xmlNode *output,
+                         void *user_data)
+{
+    for (GList *iter = user_data; iter != NULL; iter = iter->next) {
+        attrd_cib_callback(msg, call_id, rc, output, iter->data);
+    }
+}
+
+static void
+free_batch_callback_data(void *user_data)
+{
+    g_list_free_full((GList *) user_data, free);
+}
+
 void
 write_attributes(bool all, bool ignore_delay)
 {
@@ -1161,49 +1256,24 @@ send_alert_attributes_value(attribute_t *a, GHashTable *t)
     }
 }
 
-void
-write_attribute(attribute_t *a, bool ignore_delay)
+/*!
+ * \internal
+ * \brief Add an attribute's current values to a CIB status update
+ *
+ * \param[in,out] a             Attribute to add
+ * \param[in,out] xml_top       Status update XML (NULL for private attribute)
+ * \param[in,out] flags         CIB call options for the update
+ * \param[in,out] alert_values  Where to save values to send alerts for
+ *
+ * \return Number of values added to \p xml_top
+ */
+static int
+add_attribute_updates(attribute_t *a, xmlNode *xml_top,
+                      enum cib_call_options *flags, GHashTable *alert_values)
 {
     int private_updates = 0, cib_updates = 0;
-    xmlNode *xml_top = NULL;
     attribute_value_t *v = NULL;
     GHashTableIter iter;
-    enum cib_call_options flags = cib_quorum_override;
-    GHashTable *alert_attribute_value = NULL;
-
-    if (a == NULL) {
-        return;
-    }
-
-    /* If this attribute will be written to the CIB ... */
-    if (!a->is_private) {
-
-        /* Defer the write if now's not a good time */
-        CRM_CHECK(the_cib != NULL, return);
-        if (a->update && (a->update < last_cib_op_done)) {
-            crm_info("Write out of '%s' continuing: update %d considered lost", a->id, a->update);
-            a->update = 0; // Don't log this message again
-
-        } else if (a->update) {
-            crm_info("Write out of '%s' delayed: update %d in progress", a->id, a->update);
-            return;
-
-        } else if (mainloop_timer_running(a->timer)) {
-            if (ignore_delay) {
-                /* 'refresh' forces a write of the current value of all attributes
-                 * Cancel any existing timers, we're writing it NOW
-                 */
-                mainloop_timer_stop(a->timer);
-                crm_debug("Write out of '%s': timer is running but ignore delay", a->id);
-            } else {
-                crm_info("Write out of '%s' delayed: timer is running", a->id);
-                return;
-            }
-        }
-
-        /* Initialize the status update XML */
-        xml_top = create_xml_node(NULL, XML_CIB_TAG_STATUS);
-    }
 
     /* Attribute will be written shortly, so clear changed flag */
     a->changed = FALSE;
@@ -1214,11 +1284,6 @@ write_attribute(attribute_t *a, bool ignore_delay)
     /* Attribute will be written shortly, so clear forced write flag */
     a->force_write = FALSE;    
 
-    /* Make the table for the attribute trap */
-    alert_attribute_value = g_hash_table_new_full(crm_strcase_hash,
-                                                  crm_strcase_equal, NULL,
-                                                  free_attribute_value);
-
     /* Iterate over each peer value of this attribute */
     g_hash_table_iter_init(&iter, a->values);
     while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & v)) {
@@ -1260,7 +1325,7 @@ write_attribute(attribute_t *a, bool ignore_delay)
         cib_updates++;
 
         /* Preservation of the attribute to transmit alert */
-        set_alert_attribute_value(alert_attribute_value, v);
+        set_alert_attribute_value(alert_values, v);
 
         free(v->requested);
         v->requested = NULL;
@@ -1270,7 +1335,7 @@ write_attribute(attribute_t *a, bool ignore_delay)
             /* Older attrd versions don't know about the cib_mixed_update
              * flag so make sure it goes to the local cib which does
              */
-            flags |= cib_mixed_update|cib_scope_local;
+            *flags |= cib_mixed_update|cib_scope_local;
         }
     }
 
@@ -1279,6 +1344,185 @@ write_attribute(attribute_t *a, bool ignore_delay)
                  private_updates, pcmk__plural_s(private_updates),
                  a->id, (a->uuid? a->uuid : "n/a"), (a->set? a->set : "n/a"));
     }
+    return cib_updates;
+}
+
+static GHashTable *
+new_alert_values(void)
+{
+    return g_hash_table_new_full(crm_strcase_hash, crm_strcase_equal, NULL,
+                                 free_attribute_value);
+}
+
+/*!
+ * \internal
+ * \brief Send a single CIB request for all batched attribute writes
+ */
+static void
+write_batched_attributes(void)
+{
+    int cib_updates = 0;
+    int call_id = 0;
+    GHashTableIter iter;
+    const char *name = NULL;
+    gpointer ignore_delay = NULL;
+    attribute_t *a = NULL;
+    GList *written = NULL;
+    xmlNode *xml_top = NULL;
+    enum cib_call_options flags = cib_quorum_override;
+
+    // Attribute name -> table of values to send alerts for
+    GHashTable *alerts = NULL;
+
+    if ((write_batch == NULL) || (g_hash_table_size(write_batch) == 0)) {
+        return;
+    }
+    if (!attrd_election_won()) {
+        // We lost the writer role while the batch was pending
+        attrd_clear_write_batch();
+        return;
+    }
+    mainloop_timer_stop(write_batch_timer);
+    CRM_CHECK(the_cib != NULL, return);
+
+    xml_top = create_xml_node(NULL, XML_CIB_TAG_STATUS);
+    alerts = g_hash_table_new_full(crm_str_hash, g_str_equal, NULL,
+                                   (GDestroyNotify) g_hash_table_destroy);
+
+    g_hash_table_iter_init(&iter, write_batch);
+    while (g_hash_table_iter_next(&iter, (gpointer *) &name, &ignore_delay)) {
+        GHashTable *alert_values = NULL;
+        int updates = 0;
+
+        a = g_hash_table_lookup(attributes, name);
+        if (a == NULL) {
+            crm_trace("Batched attribute %s no longer exists", name);
+            continue;
+        }
+
+        /* A new value may have started dampening since the write was
+         * batched, in which case the timer will write it later
+         */
+        if (mainloop_timer_running(a->timer)) {
+            if (GPOINTER_TO_INT(ignore_delay)) {
+                mainloop_timer_stop(a->timer);
+            } else {
+                crm_info("Write out of '%s' delayed: timer is running", a->id);
+                continue;
+            }
+        }
+
+        alert_values = new_alert_values();
+        updates = add_attribute_updates(a, xml_top, &flags, alert_values);
+        if (updates > 0) {
+            cib_updates += updates;
+            written = g_list_prepend(written, a);
+            g_hash_table_insert(alerts, a->id, alert_values);
+        } else {
+            g_hash_table_destroy(alert_values);
+        }
+    }
+    g_hash_table_remove_all(write_batch);
+
+    if (cib_updates) {
+        GList *names = NULL;
+
+        crm_log_xml_trace(xml_top, __FUNCTION__);
+        call_id = cib_internal_op(the_cib, CIB_OP_MODIFY, NULL,
+                                  XML_CIB_TAG_STATUS, xml_top, NULL, flags,
+                                  NULL);
+
+        crm_info("Sent CIB request %d with %d change%s for %d attribute%s",
+                 call_id, cib_updates, pcmk__plural_s(cib_updates),
+                 g_list_length(written),
+                 pcmk__plural_s(g_list_length(written)));
+
+        for (GList *lpc = written; lpc != NULL; lpc = lpc->next) {
+            a = lpc->data;
+
+            // Each attribute tracks the request as if it were its own
+            a->update = call_id;
+            names = g_list_prepend(names, strdup(a->id));
+
+            /* Transmit alert of the attribute */
+            send_alert_attributes_value(a, g_hash_table_lookup(alerts, a->id));
+        }
+
+        the_cib->cmds->register_callback_full(the_cib, call_id,
+                                              CIB_OP_TIMEOUT_S, FALSE, names,
+                                              "attrd_cib_batch_callback",
+                                              attrd_cib_batch_callback,
+                                              free_batch_callback_data);
+    }
+
+    g_list_free(written);
+    g_hash_table_destroy(alerts);
+    free_xml(xml_top);
+}
+
+void
+write_attribute(attribute_t *a, bool ignore_delay)
+{
+    int cib_updates = 0;
+    xmlNode *xml_top = NULL;
+    enum cib_call_options flags = cib_quorum_override;
+    GHashTable *alert_attribute_value = NULL;
+
+    if (a == NULL) {
+        return;
+    }
+
+    /* If this attribute will be written to the CIB ... */
+    if (!a->is_private) {
+
+        /* Defer the write if now's not a good time */
+        CRM_CHECK(the_cib != NULL, return);
+        if (a->update && (a->update < last_cib_op_done)) {
+            crm_info("Write out of '%s' continuing: update %d considered lost", a->id, a->update);
+            a->update = 0; // Don't log this message again
+
+        } else if (a->update) {
+            crm_info("Write out of '%s' delayed: update %d in progress", a->id, a->update);
+            return;
+
+        } else if (mainloop_timer_running(a->timer)) {
+            if (ignore_delay) {
+                /* 'refresh' forces a write of the current value of all attributes
+                 * Cancel any existing timers, we're writing it NOW
+                 */
+                mainloop_timer_stop(a->timer);
+                crm_debug("Write out of '%s': timer is running but ignore delay", a->id);
+            } else {
+                crm_info("Write out of '%s' delayed: timer is running", a->id);
+                return;
+            }
+        }
+
+        /* Coalesce the write with others due soon, unless it must be
+         * made as a particular user
+         */
+        if ((write_batch != NULL) && (a->user == NULL)) {
+            gpointer old = g_hash_table_lookup(write_batch, a->id);
+
+            crm_trace("Batching write of '%s'", a->id);
+            g_hash_table_replace(write_batch, strdup(a->id),
+                                 GINT_TO_POINTER(ignore_delay
+                                                 || GPOINTER_TO_INT(old)));
+            if (!mainloop_timer_running(write_batch_timer)) {
+                mainloop_timer_start(write_batch_timer);
+            }
+            return;
+        }
+
+        /* Initialize the status update XML */
+        xml_top = create_xml_node(NULL, XML_CIB_TAG_STATUS);
+    }
+
+    /* Make the table for the attribute trap */
+    alert_attribute_value = new_alert_values();
+
+    cib_updates = add_attribute_updates(a, xml_top, &flags,
+                                        alert_attribute_value);
     if (cib_updates) {
         crm_log_xml_trace(xml_top, __FUNCTION__);
 
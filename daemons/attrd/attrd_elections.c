@@ -84,6 +84,7 @@ attrd_handle_election_op(const crm_node_t *peer, xmlNode *xml)
                 crm_debug("Election lost, presuming %s is writer for now",
                           peer_writer);
             }
+            attrd_clear_write_batch();
             break;
 
         case election_in_progress:
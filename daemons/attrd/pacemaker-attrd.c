@@ -423,6 +423,7 @@ main(int argc, char **argv)
     // Initialization that requires the cluster to be connected
     attrd_election_init();
     attrd_cib_init();
+    attrd_init_write_batch();
 
     /* Set a private attribute for ourselves with the protocol version we
      * support. This lets all nodes determine the minimum supported version
@@ -439,6 +440,7 @@ main(int argc, char **argv)
     crm_info("Shutting down attribute manager");
 
     attrd_election_fini();
+    attrd_free_write_batch();
     attrd_ipc_fini();
     attrd_lrmd_disconnect();
     attrd_cib_disconnect();
@@ -117,6 +117,9 @@ extern GHashTable *attributes;
 #define CIB_OP_TIMEOUT_S 120
 
 void write_attributes(bool all, bool ignore_delay);
+void attrd_init_write_batch(void);
+void attrd_free_write_batch(void);
+void attrd_clear_write_batch(void);
 void attrd_broadcast_protocol(void);
 void attrd_peer_message(crm_node_t *client, xmlNode *msg);
 void attrd_client_peer_remove(const char *client_name, xmlNode *xml);
@@ -383,6 +383,35 @@ cib_diskwrite_complete(mainloop_child_t * p, pid_t pid, int core, int signo, int
     mainloop_trigger_complete(cib_writer);
 }
 
+/*!
+ * \internal
+ * \brief Copy the parts of a CIB that get written to disk
+ *
+ * \param[in] cib  CIB to copy
+ *
+ * \return Copy of \p cib with an empty status section
+ * \note The status section is discarded when writing, so copying it would
+ *       only add the cost of the largest part of the CIB to every write.
+ */
+static xmlNode *
+copy_cib_for_disk(xmlNode *cib)
+{
+    xmlNode *child = NULL;
+    xmlNode *copy = create_xml_node(NULL, (const char *) cib->name);
+
+    copy_in_properties(copy, cib);
+    for (child = __xml_first_child(cib); child != NULL;
+         child = __xml_next(child)) {
+
+        if (safe_str_eq((const char *) child->name, XML_CIB_TAG_STATUS)) {
+            create_xml_node(copy, XML_CIB_TAG_STATUS);
+        } else {
+            add_node_copy(copy, child);
+        }
+    }
+    return copy;
+}
+
 int
 write_cib_contents(gpointer p)
 {
@@ -392,7 +421,7 @@ write_cib_contents(gpointer p)
     /* Make a copy of the CIB to write (possibly in a forked child) */
     if (p) {
         /* Synchronous write out */
-        cib_local = copy_xml(p);
+        cib_local = copy_cib_for_disk(p);
 
     } else {
         int pid = 0;
@@ -427,9 +456,10 @@ write_cib_contents(gpointer p)
         /* Asynchronous write-out after a fork() */
 
         /* In theory, we can scribble on the_cib here and not affect the parent,
-         * but let's be safe anyway.
+         * but let's be safe anyway. Copying only what gets written also avoids
+         * touching (and thus duplicating) the status section's memory pages.
          */
-        cib_local = copy_xml(the_cib);
+        cib_local = copy_cib_for_disk(the_cib);
     }
 
     /* Write the CIB */
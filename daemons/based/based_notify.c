@@ -32,8 +32,8 @@ int pending_updates = 0;
 
 struct cib_notification_s {
     xmlNode *msg;
-    struct iovec *iov;
-    int32_t iov_size;
+    pcmk__ipc_shared_event_t *event;    // Serialized once for all IPC clients
+    char *text;                         // Serialized on demand for remotes
 };
 
 void attach_cib_generation(xmlNode * msg, const char *field, xmlNode * a_cib);
@@ -82,8 +82,8 @@ cib_notify_send_one(gpointer key, gpointer value, gpointer user_data)
     if (do_send) {
         switch (client->kind) {
             case PCMK__CLIENT_IPC:
-                if (pcmk__ipc_send_iov(client, update->iov,
-                                       crm_ipc_server_event) != pcmk_rc_ok) {
+                if (pcmk__ipc_send_shared_event(client, update->event,
+                                                crm_ipc_server_event) != pcmk_rc_ok) {
                     crm_warn("Notification of client %s/%s failed", client->name, client->id);
                 }
                 break;
@@ -91,8 +91,11 @@ cib_notify_send_one(gpointer key, gpointer value, gpointer user_data)
             case PCMK__CLIENT_TLS:
 #endif
             case PCMK__CLIENT_TCP:
+                if (update->text == NULL) {
+                    update->text = dump_xml_unformatted(update->msg);
+                }
                 crm_debug("Sent %s notification to client %s/%s", type, client->name, client->id);
-                crm_remote_send(client->remote, update->msg);
+                pcmk__remote_send_text(client->remote, update->text);
                 break;
             default:
                 crm_err("Unknown transport %d for %s", client->kind, client->name);
@@ -104,24 +107,32 @@ cib_notify_send_one(gpointer key, gpointer value, gpointer user_data)
 static void
 cib_notify_send(xmlNode * xml)
 {
-    struct iovec *iov;
+    struct iovec *iov = NULL;
     struct cib_notification_s update;
 
-    ssize_t bytes = 0;
-    int rc = pcmk__ipc_prepare_iov(0, xml, 0, &iov, &bytes);
+    /* The same event goes to every client, so use the codec they all
+     * support in the rare case it needs compression
+     */
+    int rc = pcmk__ipc_prepare_iov(0, xml, 0, pcmk__codec_bzip2, &iov, NULL);
 
     crm_trace("Notifying clients");
     if (rc == pcmk_rc_ok) {
         update.msg = xml;
-        update.iov = iov;
-        update.iov_size = bytes;
+        update.event = pcmk__ipc_new_shared_event(iov);
+        update.text = NULL;
         pcmk__foreach_ipc_client_remove(cib_notify_send_one, &update);
 
+        /* Clients that haven't flushed the event yet keep their own
+         * references to it
+         */
+        pcmk__ipc_unref_shared_event(update.event);
+        free(update.text);
+
     } else {
         crm_notice("Could not notify clients: %s " CRM_XS " rc=%d",
                    pcmk_rc_str(rc), rc);
+        pcmk_free_ipc_event(iov);
     }
-    pcmk_free_ipc_event(iov);
     crm_trace("Notify complete");
 }
 
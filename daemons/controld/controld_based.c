@@ -56,6 +56,10 @@ do_cib_control(long long action,
 
     if (action & A_CIB_STOP) {
 
+        if (fsa_cib_conn->state != cib_disconnected) {
+            controld_flush_history_updates();
+        }
+
         if (fsa_cib_conn->state != cib_disconnected && last_resource_update != 0) {
             crm_info("Waiting for resource update %d to complete", last_resource_update);
             crmd_fsa_stall(FALSE);
@@ -254,6 +258,7 @@ controld_delete_node_state(const char *uname, enum controld_section_e section,
     } else {
         int call_id;
 
+        controld_flush_history_updates();
         options |= cib_quorum_override|cib_xpath|cib_multiple;
         call_id = fsa_cib_conn->cmds->remove(fsa_cib_conn, xpath, NULL, options);
         crm_info("Deleting %s (via CIB call %d) " CRM_XS " xpath=%s",
@@ -301,6 +306,7 @@ controld_delete_resource_history(const char *rsc_id, const char *node,
     }
 
     // Ask CIB to delete the entry
+    controld_flush_history_updates();
     xpath = crm_strdup_printf(XPATH_RESOURCE_HISTORY, node, rsc_id);
     rc = cib_internal_op(fsa_cib_conn, CIB_OP_DELETE, NULL, xpath, NULL,
                          NULL, call_options|cib_xpath, user_name);
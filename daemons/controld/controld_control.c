@@ -36,6 +36,7 @@ crm_trigger_t *fsa_source = NULL;
 crm_trigger_t *config_read = NULL;
 bool no_quorum_suicide_escalation = FALSE;
 bool controld_shutdown_lock_enabled = false;
+guint controld_history_delay_ms = 0;
 
 /*	 A_HA_CONNECT	*/
 void
@@ -581,6 +582,15 @@ static pe_cluster_option crmd_opts[] = {
         "*** Advanced Use Only *** Enabling this option will slow down cluster recovery under all conditions",
         "Delay cluster recovery for the configured interval to allow for additional/related events to occur.\n"
         "Useful if your configuration is sensitive to the order in which ping updates arrive."
+    },
+    {
+        "history-update-delay", NULL, "time", NULL, "50ms", &check_timer,
+        "*** Advanced Use Only *** How long to wait so that resource operation "
+            "results can be recorded in the CIB together",
+        "Results that arrive within this interval of each other are written "
+            "to the CIB's status section in a single update, which reduces "
+            "load on the CIB manager when many actions complete at once, such "
+            "as after a failover. Zero records each result immediately."
     },
 	{ "stonith-watchdog-timeout", NULL, "time", NULL, NULL, &check_sbd_timeout,
 	  "How long to wait before we can assume nodes are safely down", NULL
@@ -696,6 +706,9 @@ config_query_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void
     value = crmd_pref(config_hash, "transition-delay");
     transition_timer->period_ms = crm_parse_interval_spec(value);
 
+    value = crmd_pref(config_hash, "history-update-delay");
+    controld_history_delay_ms = crm_parse_interval_spec(value);
+
     value = crmd_pref(config_hash, "join-integration-timeout");
     integration_timer->period_ms = crm_parse_interval_spec(value);
 
@@ -1005,6 +1005,7 @@ erase_lrm_history_by_op(lrm_state_t *lrm_state, lrmd_event_data_t *op)
     crm_debug("Erasing resource operation history for " CRM_OP_FMT " (call=%d)",
               op->rsc_id, op->op_type, op->interval_ms, op->call_id);
 
+    controld_flush_history_updates();
     fsa_cib_conn->cmds->remove(fsa_cib_conn, XML_CIB_TAG_STATUS, xml_top,
                                cib_quorum_override);
 
@@ -1066,6 +1067,7 @@ erase_lrm_history_by_id(lrm_state_t *lrm_state, const char *rsc_id,
 
     crm_debug("Erasing resource operation history for %s on %s (call=%d)",
               key, rsc_id, call_id);
+    controld_flush_history_updates();
     fsa_cib_conn->cmds->remove(fsa_cib_conn, op_xpath, NULL,
                                cib_quorum_override | cib_xpath);
     free(op_xpath);
@@ -2344,6 +2346,18 @@ do_lrm_rsc_op(lrm_state_t *lrm_state, lrmd_rsc_info_t *rsc,
 
 int last_resource_update = 0;
 
+/* Resource history updates not yet sent to the CIB. When a history update
+ * delay is configured, results received within that window are merged into
+ * a single status update, so that a burst of results (such as after a
+ * failover) costs the CIB manager one modification rather than one per result.
+ */
+static xmlNode *pending_history = NULL;
+static int pending_history_count = 0;
+static guint pending_history_timer = 0;
+
+// Maximum number of results to merge into a single CIB update
+#define MAX_BATCHED_HISTORY 100
+
 static void
 cib_rsc_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void *user_data)
 {
@@ -2363,6 +2377,78 @@ cib_rsc_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void *use
     }
 }
 
+/*!
+ * \internal
+ * \brief Send any batched resource history updates to the CIB
+ *
+ * \note This must be called before deleting resource history from the CIB,
+ *       so that a batched result cannot be recorded after the deletion.
+ */
+void
+controld_flush_history_updates(void)
+{
+    int rc = pcmk_ok;
+    int call_opt = crmd_cib_smart_opt();
+
+    if (pending_history_timer != 0) {
+        g_source_remove(pending_history_timer);
+        pending_history_timer = 0;
+    }
+    if (pending_history == NULL) {
+        return;
+    }
+
+    crm_log_xml_trace(pending_history, __FUNCTION__);
+    fsa_cib_update(XML_CIB_TAG_STATUS, pending_history, call_opt, rc, NULL);
+
+    if (rc > 0) {
+        last_resource_update = rc;
+    }
+    crm_debug("Sent %d batched resource state update%s in CIB call %d",
+              pending_history_count, pcmk__plural_s(pending_history_count),
+              rc);
+    fsa_register_cib_callback(rc, FALSE, NULL, cib_rsc_callback);
+
+    free_xml(pending_history);
+    pending_history = NULL;
+    pending_history_count = 0;
+}
+
+static gboolean
+flush_history_cb(gpointer user_data)
+{
+    pending_history_timer = 0;
+    controld_flush_history_updates();
+    return FALSE;
+}
+
+/*!
+ * \internal
+ * \brief Merge a resource history update into the pending batch
+ *
+ * \param[in] update  Status section update for a single operation result
+ *
+ * \note The update is merged the same way the CIB manager applies a
+ *       modification, so sending the batch has the same effect as sending
+ *       each update in order.
+ */
+static void
+batch_history_update(xmlNode *update)
+{
+    if (pending_history == NULL) {
+        pending_history = create_xml_node(NULL, XML_CIB_TAG_STATUS);
+    }
+    update_xml_child(pending_history, update);
+
+    if (++pending_history_count >= MAX_BATCHED_HISTORY) {
+        controld_flush_history_updates();
+
+    } else if (pending_history_timer == 0) {
+        pending_history_timer = g_timeout_add(controld_history_delay_ms,
+                                              flush_history_cb, NULL);
+    }
+}
+
 /* Only successful stops, and probes that found the resource inactive, get locks
  * recorded in the history. This ensures the resource stays locked to the node
  * until it is active there again after the node comes back up.
@@ -2483,6 +2569,12 @@ do_update_resource(const char *node_name, lrmd_rsc_info_t *rsc,
      * the alternative however means blocking here for too long, which
      * isn't acceptable
      */
+    if (controld_history_delay_ms > 0) {
+        batch_history_update(update);
+        crm_trace("Batched resource state update for %s=%u on %s",
+                  op->op_type, op->interval_ms, op->rsc_id);
+        goto cleanup;
+    }
     fsa_cib_update(XML_CIB_TAG_STATUS, update, call_opt, rc, NULL);
 
     if (rc > 0) {
@@ -177,5 +177,6 @@ void controld_ack_event_directly(const char *to_host, const char *to_sys,
                                  const char *rsc_id);
 void controld_rc2event(lrmd_event_data_t *event, int rc);
 void controld_trigger_delete_refresh(const char *from_sys, const char *rsc_id);
+void controld_flush_history_updates(void);
 
 #endif
@@ -1096,6 +1096,12 @@ handle_response(xmlNode *stored_msg)
         if (msg_ref == NULL) {
             crm_err("%s - Ignoring calculation with no reference", op);
 
+        } else if (safe_str_eq(msg_ref, fsa_pe_ref)
+                   && crm_is_true(crm_element_value(stored_msg,
+                                                    F_CRM_SCHED_RESEND))) {
+            // Scheduler couldn't use a patchset, so send the full input
+            controld_resend_sched_input();
+
         } else if (safe_str_eq(msg_ref, fsa_pe_ref)) {
             ha_msg_input_t fsa_input;
 
@@ -21,6 +21,21 @@
 
 static mainloop_io_t *pe_subsystem = NULL;
 
+/* Last input sent to the scheduler, and its digest. While the scheduler
+ * connection stays up, later inputs are sent as patchsets against it.
+ */
+static xmlNode *last_sched_input = NULL;
+static char *last_sched_digest = NULL;
+
+static void
+forget_sched_input(void)
+{
+    free_xml(last_sched_input);
+    last_sched_input = NULL;
+    free(last_sched_digest);
+    last_sched_digest = NULL;
+}
+
 /*!
  * \internal
  * \brief Close any scheduler connection and free associated memory
@@ -29,6 +44,7 @@ void
 pe_subsystem_free(void)
 {
     clear_bit(fsa_input_register, R_PE_REQUIRED);
+    forget_sched_input();
     if (pe_subsystem) {
         controld_expect_sched_reply(NULL);
         mainloop_del_ipc_client(pe_subsystem);
@@ -59,7 +75,8 @@ save_cib_contents(xmlNode *msg, int call_id, int rc, xmlNode *output,
     CRM_CHECK(id != NULL, return);
 
     if (rc == pcmk_ok) {
-        char *filename = crm_strdup_printf(PE_STATE_DIR "/pe-core-%s.bz2", id);
+        char *filename = crm_strdup_printf(PE_STATE_DIR "/pe-core-%s.%s", id,
+                                           pcmk__compressed_file_ext());
 
         if (write_xml_file(output, filename, TRUE) < 0) {
             crm_err("Could not save Cluster Information Base to %s after scheduler crash",
@@ -110,6 +127,7 @@ pe_ipc_destroy(gpointer user_data)
 
     clear_bit(fsa_input_register, R_PE_CONNECTED);
     pe_subsystem = NULL;
+    forget_sched_input();
     mainloop_set_trigger(fsa_source);
     return;
 }
@@ -399,6 +417,108 @@ force_local_option(xmlNode *xml, const char *attr_name, const char *attr_value)
     freeXpathObject(xpathObj);
 }
 
+/*!
+ * \internal
+ * \brief Create a scheduler request for a new input
+ *
+ * If the scheduler has a previous input, the request contains only a v2
+ * patchset against it, identified by the previous input's digest.
+ *
+ * \param[in,out] input  Scheduler input (change tracking may be enabled)
+ *
+ * \return Newly created scheduler request
+ */
+static xmlNode *
+create_sched_request(xmlNode *input)
+{
+    xmlNode *cmd = NULL;
+    xmlNode *patchset = NULL;
+    char *digest = NULL;
+    const char *version = crm_element_value(input, XML_ATTR_CRM_VERSION);
+
+    if (last_sched_input != NULL) {
+        xml_calculate_changes(last_sched_input, input);
+        patchset = xml_create_patchset(2, last_sched_input, input, NULL,
+                                       FALSE);
+        xml_accept_changes(input);
+    }
+
+    // This is checked when the patchset is applied
+    digest = calculate_xml_versioned_digest(input, FALSE, TRUE, version);
+
+    if (last_sched_input != NULL) {
+        // With no changes, the request has no data
+        if (patchset != NULL) {
+            crm_xml_add(patchset, XML_ATTR_DIGEST, digest);
+        }
+        cmd = create_request(CRM_OP_PECALC, patchset, NULL, CRM_SYSTEM_PENGINE,
+                             CRM_SYSTEM_DC, NULL);
+        crm_xml_add(cmd, F_CRM_SCHED_BASE_DIGEST, last_sched_digest);
+        crm_trace("Sending scheduler input as patchset against %s",
+                  last_sched_digest);
+        free_xml(patchset);
+
+    } else {
+        cmd = create_request(CRM_OP_PECALC, input, NULL, CRM_SYSTEM_PENGINE,
+                             CRM_SYSTEM_DC, NULL);
+    }
+    crm_xml_add(cmd, F_CRM_SCHED_INPUT_DIGEST, digest);
+
+    forget_sched_input();
+    last_sched_input = copy_xml(input);
+    last_sched_digest = digest;
+    return cmd;
+}
+
+/*!
+ * \internal
+ * \brief Send a request to the scheduler and wait for its reply
+ *
+ * \param[in] cmd  Scheduler request to send
+ */
+static void
+send_sched_request(xmlNode *cmd)
+{
+    int rc = pe_subsystem_send(cmd);
+
+    if (rc < 0) {
+        crm_err("Could not contact the scheduler: %s " CRM_XS " rc=%d",
+                pcmk_strerror(rc), rc);
+        forget_sched_input();
+        register_fsa_error_adv(C_FSA_INTERNAL, I_ERROR, NULL, NULL, __FUNCTION__);
+    } else {
+        controld_expect_sched_reply(cmd);
+        crm_debug("Invoking the scheduler: query=%d, ref=%s, seq=%llu, quorate=%d",
+                  fsa_pe_query, fsa_pe_ref, crm_peer_seq, fsa_has_quorum);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Resend the last scheduler input in full
+ *
+ * This is used when the scheduler could not apply a patchset because it did
+ * not have the expected previous input.
+ */
+void
+controld_resend_sched_input(void)
+{
+    xmlNode *cmd = NULL;
+
+    if (last_sched_input == NULL) {
+        crm_info("Scheduler needs full input, requesting current CIB");
+        register_fsa_action(A_PE_INVOKE);
+        return;
+    }
+
+    crm_info("Scheduler needs full input, resending %s", last_sched_digest);
+    cmd = create_request(CRM_OP_PECALC, last_sched_input, NULL,
+                         CRM_SYSTEM_PENGINE, CRM_SYSTEM_DC, NULL);
+    crm_xml_add(cmd, F_CRM_SCHED_INPUT_DIGEST, last_sched_digest);
+    send_sched_request(cmd);
+    free_xml(cmd);
+}
+
 static void
 do_pe_invoke_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void *user_data)
 {
@@ -452,17 +572,7 @@ do_pe_invoke_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void
         crm_xml_add_int(output, XML_ATTR_QUORUM_PANIC, 1);
     }
 
-    cmd = create_request(CRM_OP_PECALC, output, NULL, CRM_SYSTEM_PENGINE, CRM_SYSTEM_DC, NULL);
-
-    rc = pe_subsystem_send(cmd);
-    if (rc < 0) {
-        crm_err("Could not contact the scheduler: %s " CRM_XS " rc=%d",
-                pcmk_strerror(rc), rc);
-        register_fsa_error_adv(C_FSA_INTERNAL, I_ERROR, NULL, NULL, __FUNCTION__);
-    } else {
-        controld_expect_sched_reply(cmd);
-        crm_debug("Invoking the scheduler: query=%d, ref=%s, seq=%llu, quorate=%d",
-                  fsa_pe_query, fsa_pe_ref, crm_peer_seq, fsa_has_quorum);
-    }
+    cmd = create_sched_request(output);
+    send_sched_request(cmd);
     free_xml(cmd);
 }
@@ -42,6 +42,7 @@ fsa_cib_anon_update(const char *section, xmlNode *data) {
 
 extern gboolean fsa_has_quorum;
 extern bool controld_shutdown_lock_enabled;
+extern guint controld_history_delay_ms;
 extern int last_peer_update;
 extern int last_resource_update;
 
@@ -61,6 +62,7 @@ void pe_subsystem_free(void);
 void controld_stop_sched_timer(void);
 void controld_free_sched_timer(void);
 void controld_expect_sched_reply(xmlNode *msg);
+void controld_resend_sched_input(void);
 
 void fsa_dump_actions(long long action, const char *text);
 void fsa_dump_inputs(int log_level, const char *text, long long input_register);
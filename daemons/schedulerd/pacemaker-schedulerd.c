@@ -48,8 +48,336 @@ series_t series[] = {
     {"pe-input", "pe-input-series-max", 400},
 };
 
+/* A reused transition may not span the start of a new minute, so that
+ * time-based rules not reflected in recheck-by still take effect promptly
+ */
+#define CACHED_GRAPH_BUCKET_S 60
+
+/* Most recently calculated transition graph, reused if the same input is
+ * submitted again before anything time-based could change the result
+ */
+typedef struct cached_graph_s {
+    xmlNode *graph;
+    time_t expires;
+    gboolean processing_error;
+    gboolean processing_warning;
+    gboolean config_error;
+    gboolean config_warning;
+} cached_graph_t;
+
+static cached_graph_t last_graph = { NULL, 0, FALSE, FALSE, FALSE, FALSE };
+
+/* Scheduler inputs are archived by a forked child (as the CIB manager does
+ * for CIB writes), so that formatting, compressing and syncing a large CIB
+ * doesn't delay the next calculation. Inputs saved while a writer is running
+ * are queued, and the next writer saves all of them.
+ */
+#define MAX_QUEUED_INPUTS 20
+
+typedef struct queued_input_s {
+    xmlNode *xml;
+    char *filename;
+} queued_input_t;
+
+static GQueue *queued_inputs = NULL;
+static pid_t input_writer = 0;
+
+/* Last input received from the controller and the digest the controller
+ * calculated for it, so later inputs can be sent as patchsets against it
+ */
+static xmlNode *last_input = NULL;
+static char *last_input_digest = NULL;
+
 void pengine_shutdown(int nsig);
 
+static void
+free_queued_input(queued_input_t *input)
+{
+    free_xml(input->xml);
+    free(input->filename);
+    free(input);
+}
+
+static bool
+write_input(xmlNode *xml, const char *filename)
+{
+    int rc = 0;
+    char *other = strdup(filename);
+    char *ext = (other == NULL)? NULL : strrchr(other, '.');
+
+    unlink(filename);
+
+    /* If PCMK_file_compression has changed since the series last wrapped
+     * around, an old input with this sequence number may have been saved
+     * with the other compressed extension
+     */
+    if (safe_str_eq(ext, "." PCMK__BZIP2_EXT)) {
+        strcpy(ext + 1, PCMK__ZSTD_EXT);
+        unlink(other);
+    } else if (safe_str_eq(ext, "." PCMK__ZSTD_EXT)) {
+        strcpy(ext + 1, PCMK__BZIP2_EXT);
+        unlink(other);
+    }
+    free(other);
+
+    rc = write_xml_file(xml, filename, TRUE);
+    if (rc < 0) {
+        crm_warn("Could not save scheduler input to %s: %s "
+                 CRM_XS " rc=%d", filename, pcmk_strerror(rc), rc);
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Write all queued scheduler inputs, plus an optional new one
+ *
+ * \param[in] xml       If not NULL, scheduler input to write after queue
+ * \param[in] filename  Where to write \p xml
+ *
+ * \return true if all inputs were written, otherwise false
+ */
+static bool
+write_inputs(xmlNode *xml, const char *filename)
+{
+    bool all_written = true;
+    queued_input_t *input = NULL;
+
+    while ((queued_inputs != NULL)
+           && ((input = g_queue_pop_head(queued_inputs)) != NULL)) {
+        all_written &= write_input(input->xml, input->filename);
+        free_queued_input(input);
+    }
+    if (xml != NULL) {
+        all_written &= write_input(xml, filename);
+    }
+    return all_written;
+}
+
+static void start_input_writer(xmlNode *xml, const char *filename);
+
+static void
+input_writer_complete(mainloop_child_t *p, pid_t pid, int core, int signo,
+                      int exitcode)
+{
+    if (signo) {
+        crm_notice("Scheduler input writer terminated with signal %d "
+                   CRM_XS " pid=%d core=%d", signo, pid, core);
+    } else {
+        do_crm_log((exitcode == 0)? LOG_TRACE : LOG_WARNING,
+                   "Scheduler input writer exited " CRM_XS " pid=%d rc=%d",
+                   pid, exitcode);
+    }
+
+    input_writer = 0;
+    if ((queued_inputs != NULL) && !g_queue_is_empty(queued_inputs)) {
+        start_input_writer(NULL, NULL);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Fork a child to write all queued scheduler inputs
+ *
+ * \param[in] xml       If not NULL, scheduler input to write after queue
+ * \param[in] filename  Where to write \p xml
+ */
+static void
+start_input_writer(xmlNode *xml, const char *filename)
+{
+    pid_t pid = 0;
+    int bb_state = qb_log_ctl(QB_LOG_BLACKBOX, QB_LOG_CONF_STATE_GET, 0);
+
+    /* Turn the blackbox off before the fork(), so the child doesn't share
+     * (or need to close) its shared memory
+     */
+    qb_log_ctl(QB_LOG_BLACKBOX, QB_LOG_CONF_ENABLED, QB_FALSE);
+
+    pid = fork();
+    if (pid == 0) {
+        /* Use _exit() because exit() could affect the parent adversely */
+        _exit(write_inputs(xml, filename)? CRM_EX_OK : CRM_EX_CANTCREAT);
+    }
+
+    if (bb_state == QB_LOG_STATE_ENABLED) {
+        qb_log_ctl(QB_LOG_BLACKBOX, QB_LOG_CONF_ENABLED, QB_TRUE);
+    }
+
+    if (pid < 0) {
+        crm_perror(LOG_WARNING,
+                   "Saving scheduler inputs synchronously after fork failure");
+        write_inputs(xml, filename);
+        return;
+    }
+
+    // The child has its own copy of everything queued
+    if (queued_inputs != NULL) {
+        g_queue_free_full(queued_inputs, (GDestroyNotify) free_queued_input);
+        queued_inputs = NULL;
+    }
+    input_writer = pid;
+    mainloop_child_add(pid, 0, "pe-input-writer", NULL, input_writer_complete);
+}
+
+/*!
+ * \internal
+ * \brief Save a scheduler input to disk without blocking the main loop
+ *
+ * \param[in] xml       Scheduler input to save
+ * \param[in] filename  Where to save \p xml
+ */
+static void
+archive_input(xmlNode *xml, const char *filename)
+{
+    queued_input_t *input = NULL;
+
+    if (input_writer == 0) {
+        start_input_writer(xml, filename);
+        return;
+    }
+
+    if (queued_inputs == NULL) {
+        queued_inputs = g_queue_new();
+
+    } else if (g_queue_get_length(queued_inputs) >= MAX_QUEUED_INPUTS) {
+        // Bound memory use by saving the oldest queued input now
+        input = g_queue_pop_head(queued_inputs);
+        crm_info("Scheduler input writer is busy, saving %s synchronously",
+                 input->filename);
+        write_input(input->xml, input->filename);
+        free_queued_input(input);
+    }
+
+    input = calloc(1, sizeof(queued_input_t));
+    CRM_ASSERT(input != NULL);
+    input->xml = copy_xml(xml);
+    input->filename = strdup(filename);
+    g_queue_push_tail(queued_inputs, input);
+}
+
+static void
+clear_cached_graph(void)
+{
+    free_xml(last_graph.graph);
+    last_graph.graph = NULL;
+    last_graph.expires = 0;
+}
+
+/*!
+ * \internal
+ * \brief Remember a newly calculated transition graph for later reuse
+ *
+ * \param[in] data_set        Working set that graph was calculated from
+ * \param[in] execution_date  When the calculation was requested
+ */
+static void
+cache_graph(pe_working_set_t *data_set, time_t execution_date)
+{
+    clear_cached_graph();
+    if (data_set->graph == NULL) {
+        return;
+    }
+
+    last_graph.graph = copy_xml(data_set->graph);
+    last_graph.expires = execution_date + CACHED_GRAPH_BUCKET_S
+                         - (execution_date % CACHED_GRAPH_BUCKET_S);
+    if ((data_set->recheck_by > 0)
+        && (data_set->recheck_by < last_graph.expires)) {
+        last_graph.expires = data_set->recheck_by;
+    }
+
+    last_graph.processing_error = was_processing_error;
+    last_graph.processing_warning = was_processing_warning;
+    last_graph.config_error = crm_config_error;
+    last_graph.config_warning = crm_config_warning;
+}
+
+/*!
+ * \internal
+ * \brief Reuse the cached transition graph if it is still valid
+ *
+ * \param[in,out] data_set        Working set to use cached graph in
+ * \param[in]     execution_date  When the calculation was requested
+ *
+ * \return TRUE if the cached graph was reused, otherwise FALSE
+ */
+static gboolean
+reuse_cached_graph(pe_working_set_t *data_set, time_t execution_date)
+{
+    if ((last_graph.graph == NULL) || (execution_date >= last_graph.expires)) {
+        clear_cached_graph();
+        return FALSE;
+    }
+
+    data_set->graph = pcmk__copy_transition_graph(last_graph.graph);
+    was_processing_error = last_graph.processing_error;
+    was_processing_warning = last_graph.processing_warning;
+    crm_config_error = last_graph.config_error;
+    crm_config_warning = last_graph.config_warning;
+    return TRUE;
+}
+
+static void
+clear_last_input(void)
+{
+    free_xml(last_input);
+    last_input = NULL;
+    free(last_input_digest);
+    last_input_digest = NULL;
+}
+
+/*!
+ * \internal
+ * \brief Get the full scheduler input from a calculation request
+ *
+ * \param[in] msg       Calculation request
+ * \param[in] xml_data  Request data (full input, or patchset against the
+ *                      last input if the request specifies a base digest)
+ *
+ * \return Full scheduler input, or NULL if a patchset could not be applied
+ */
+static xmlNode *
+unpack_input(xmlNode *msg, xmlNode *xml_data)
+{
+    int rc = pcmk_ok;
+    const char *base = crm_element_value(msg, F_CRM_SCHED_BASE_DIGEST);
+    const char *digest = crm_element_value(msg, F_CRM_SCHED_INPUT_DIGEST);
+
+    if (base == NULL) {
+        clear_last_input();
+        if (digest == NULL) {
+            return xml_data; // Controller doesn't send patchsets
+        }
+        last_input = copy_xml(xml_data);
+        last_input_digest = strdup(digest);
+        return last_input;
+    }
+
+    if ((last_input == NULL) || safe_str_neq(base, last_input_digest)) {
+        crm_info("Requesting full input: patchset is against %s, not %s",
+                 base, crm_str(last_input_digest));
+        clear_last_input();
+        return NULL;
+    }
+
+    // No data means the input hasn't changed
+    if (xml_data != NULL) {
+        rc = xml_apply_patchset(last_input, xml_data, FALSE);
+        if (rc != pcmk_ok) {
+            crm_info("Requesting full input: could not apply patchset: %s "
+                     CRM_XS " rc=%d", pcmk_strerror(rc), rc);
+            clear_last_input();
+            return NULL;
+        }
+    }
+
+    free(last_input_digest);
+    last_input_digest = digest? strdup(digest) : NULL;
+    crm_trace("Applied patchset to scheduler input %s", base);
+    return last_input;
+}
+
 static gboolean
 process_pe_message(xmlNode *msg, xmlNode *xml_data, pcmk__client_t *sender)
 {
@@ -100,27 +428,47 @@ process_pe_message(xmlNode *msg, xmlNode *xml_data, pcmk__client_t *sender)
             set_bit(sched_data_set->flags, pe_flag_no_compat);
         }
 
-        digest = calculate_xml_versioned_digest(xml_data, FALSE, FALSE, CRM_FEATURE_SET);
-        converted = copy_xml(xml_data);
-        if (cli_config_update(&converted, NULL, TRUE) == FALSE) {
-            sched_data_set->graph = create_xml_node(NULL, XML_TAG_GRAPH);
-            crm_xml_add_int(sched_data_set->graph, "transition_id", 0);
-            crm_xml_add_int(sched_data_set->graph, "cluster-delay", 0);
-            process = FALSE;
-            free(digest);
+        xml_data = unpack_input(msg, xml_data);
+        if (xml_data == NULL) {
+            reply = create_reply(msg, NULL);
+            CRM_ASSERT(reply != NULL);
+            crm_xml_add(reply, F_CRM_SCHED_RESEND, XML_BOOLEAN_TRUE);
+            pcmk__ipc_send_xml(sender, 0, reply, crm_ipc_server_event);
+            free_xml(reply);
+            return TRUE;
+        }
 
-        } else if (safe_str_eq(digest, last_digest)) {
-            crm_info("Input has not changed since last time, not saving to disk");
+        digest = calculate_xml_versioned_digest(xml_data, FALSE, FALSE, CRM_FEATURE_SET);
+        if (safe_str_eq(digest, last_digest)
+            && reuse_cached_graph(sched_data_set, execution_date)) {
+            crm_info("Input has not changed since last time, reusing transition");
             is_repoke = TRUE;
+            process = FALSE;
             free(digest);
 
         } else {
-            free(last_digest);
-            last_digest = digest;
+            converted = copy_xml(xml_data);
+            if (cli_config_update(&converted, NULL, TRUE) == FALSE) {
+                sched_data_set->graph = create_xml_node(NULL, XML_TAG_GRAPH);
+                crm_xml_add_int(sched_data_set->graph, "transition_id", 0);
+                crm_xml_add_int(sched_data_set->graph, "cluster-delay", 0);
+                process = FALSE;
+                free(digest);
+
+            } else if (safe_str_eq(digest, last_digest)) {
+                crm_info("Input has not changed since last time, not saving to disk");
+                is_repoke = TRUE;
+                free(digest);
+
+            } else {
+                free(last_digest);
+                last_digest = digest;
+            }
         }
 
         if (process) {
             pcmk__schedule_actions(sched_data_set, converted, NULL);
+            cache_graph(sched_data_set, execution_date);
         }
 
         series_id = get_series();
@@ -189,9 +537,14 @@ process_pe_message(xmlNode *msg, xmlNode *xml_data, pcmk__client_t *sender)
         pcmk__log_transition_summary(filename);
 
         if (is_repoke == FALSE && series_wrap != 0) {
-            unlink(filename);
+            /* The sequence is updated immediately, so the next input gets a
+             * new file name even if this one hasn't been written yet
+             */
             crm_xml_add_ll(xml_data, "execution-date", (long long) execution_date);
-            write_xml_file(xml_data, filename, TRUE);
+            archive_input(xml_data, filename);
+
+            // Keep the input identical to what the controller last sent
+            xml_remove_prop(xml_data, "execution-date");
             pcmk__write_series_sequence(PE_STATE_DIR, series[series_id].name,
                                         ++seq, series_wrap);
         } else {
@@ -355,6 +708,9 @@ void
 pengine_shutdown(int nsig)
 {
     mainloop_del_ipc_server(ipcs);
+    clear_cached_graph();
+    clear_last_input();
+    write_inputs(NULL, NULL);
     pe_free_working_set(sched_data_set);
     crm_exit(CRM_EX_OK);
 }
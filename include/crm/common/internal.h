@@ -117,6 +117,28 @@ gboolean crm_ends_with_ext(const char *s, const char *match);
 char *add_list_element(char *list, const char *value);
 bool crm_compress_string(const char *data, int length, int max, char **result,
                          unsigned int *result_len);
+
+// Compression codecs (these values are sent between peers, so never change them)
+enum pcmk__codec {
+    pcmk__codec_none    = 0,
+    pcmk__codec_bzip2   = 1,
+    pcmk__codec_zstd    = 2,
+};
+
+// File name extensions for compressed files
+#define PCMK__BZIP2_EXT "bz2"
+#define PCMK__ZSTD_EXT  "zst"
+
+const char *pcmk__codec_text(enum pcmk__codec codec);
+const char *pcmk__compressed_file_ext(void);
+bool pcmk__codec_supported(enum pcmk__codec codec);
+enum pcmk__codec pcmk__codec_detect(const char *data, size_t length);
+bool pcmk__compress(enum pcmk__codec codec, const char *data,
+                    unsigned int length, unsigned int max, char **result,
+                    unsigned int *result_len);
+int pcmk__decompress(enum pcmk__codec codec, const char *data,
+                     unsigned int length, char *result,
+                     unsigned int *result_len);
 gint crm_alpha_sort(gconstpointer a, gconstpointer b);
 
 /* Correctly displaying singular or plural is complicated; consider "1 node has"
@@ -41,6 +41,8 @@ enum crm_ipc_flags
     crm_ipc_flags_none      = 0x00000000,
 
     crm_ipc_compressed      = 0x00000001, /* Message has been compressed */
+    crm_ipc_compressed_zstd = 0x00000002, /* ... with zstd rather than bzip2 */
+    crm_ipc_accepts_zstd    = 0x00000004, /* Sender can decompress zstd */
 
     crm_ipc_proxied         = 0x00000100, /* _ALL_ replies to proxied connections need to be sent as events */
     crm_ipc_client_response = 0x00000200, /* A Response is expected in reply */
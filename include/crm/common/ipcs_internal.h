@@ -23,8 +23,10 @@ extern "C" {
 
 #  include <crm/common/ipc.h>
 #  include <crm/common/mainloop.h>
+#  include <crm/common/internal.h>  // enum pcmk__codec
 
 typedef struct pcmk__client_s pcmk__client_t;
+typedef struct pcmk__ipc_shared_event_s pcmk__ipc_shared_event_t;
 
 enum pcmk__client_type {
     PCMK__CLIENT_IPC = 1,
@@ -57,6 +59,7 @@ struct pcmk__remote_s {
 enum pcmk__client_flags {
     pcmk__client_proxied    = 0x00001, /* ipc_proxy code only */
     pcmk__client_privileged = 0x00002, /* root or cluster user */
+    pcmk__client_zstd       = 0x00004, /* can decompress zstd */
 };
 
 struct pcmk__client_s {
@@ -116,11 +119,16 @@ void pcmk__ipc_send_ack_as(const char *function, int line, pcmk__client_t *c,
     pcmk__ipc_send_ack_as(__FUNCTION__, __LINE__, (c), (req), (flags), (tag))
 
 int pcmk__ipc_prepare_iov(uint32_t request, xmlNode *message,
-                          uint32_t max_send_size,
+                          uint32_t max_send_size, enum pcmk__codec codec,
                           struct iovec **result, ssize_t *bytes);
 int pcmk__ipc_send_xml(pcmk__client_t *c, uint32_t request, xmlNode *message,
                        uint32_t flags);
 int pcmk__ipc_send_iov(pcmk__client_t *c, struct iovec *iov, uint32_t flags);
+pcmk__ipc_shared_event_t *pcmk__ipc_new_shared_event(struct iovec *iov);
+void pcmk__ipc_unref_shared_event(pcmk__ipc_shared_event_t *event);
+int pcmk__ipc_send_shared_event(pcmk__client_t *c,
+                                pcmk__ipc_shared_event_t *event,
+                                uint32_t flags);
 xmlNode *pcmk__client_data2xml(pcmk__client_t *c, void *data, size_t size,
                                uint32_t *id, uint32_t *flags);
 
@@ -15,6 +15,7 @@
 typedef struct pcmk__remote_s pcmk__remote_t;
 
 int crm_remote_send(pcmk__remote_t *remote, xmlNode *msg);
+int pcmk__remote_send_text(pcmk__remote_t *remote, const char *xml_text);
 int crm_remote_ready(pcmk__remote_t *remote, int total_timeout /*ms */ );
 gboolean crm_remote_recv(pcmk__remote_t *remote, int total_timeout /*ms */,
                          int *disconnected);
@@ -163,4 +163,17 @@ pcmk__xml_artefact_root(enum pcmk__xml_artefact_ns ns);
 char *pcmk__xml_artefact_path(enum pcmk__xml_artefact_ns ns,
                               const char *filespec);
 
+bool pcmk__xml_status_only_changes(xmlNode *xml);
+
+// Reusable buffer for serialized XML (see pcmk__xml_serialize())
+typedef struct pcmk__xml_buf_s {
+    char *str;      // Serialized XML (NUL-terminated)
+    size_t len;     // Length of str, not including terminating NUL
+    size_t size;    // Number of bytes allocated for str
+} pcmk__xml_buf_t;
+
+const char *pcmk__xml_serialize(xmlNode *xml, pcmk__xml_buf_t *buf);
+char *pcmk__xml_buf_steal(pcmk__xml_buf_t *buf);
+void pcmk__xml_buf_done(pcmk__xml_buf_t *buf);
+
 #endif
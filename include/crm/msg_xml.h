@@ -67,6 +67,9 @@ extern "C" {
 #  define F_CRM_ELECTION_OWNER		"election-owner"
 #  define F_CRM_TGRAPH			"crm-tgraph-file"
 #  define F_CRM_TGRAPH_INPUT		"crm-tgraph-in"
+#  define F_CRM_SCHED_INPUT_DIGEST	"crm-sched-input-digest"
+#  define F_CRM_SCHED_BASE_DIGEST	"crm-sched-base-digest"
+#  define F_CRM_SCHED_RESEND		"crm-sched-resend"
 
 #  define F_CRM_THROTTLE_MODE		"crm-limit-mode"
 #  define F_CRM_THROTTLE_MAX		"crm-limit-max"
@@ -315,6 +315,18 @@ GList *pe__resource_actions(const pe_resource_t *rsc, const pe_node_t *node,
 
 extern void pe_free_action(action_t * action);
 
+// Region ("arena") allocator for objects with working set lifetime
+typedef struct pe__arena_s pe__arena_t;
+
+pe__arena_t *pe__arena_new(void);
+void *pe__arena_alloc(pe__arena_t *arena, size_t size);
+void pe__arena_free(pe__arena_t *arena);
+void pe__arena_stats(const pe__arena_t *arena, unsigned long long *allocs,
+                     unsigned long long *bytes);
+pe__arena_t *pe__working_set_arena(pe_working_set_t *data_set);
+const char *pe__intern(pe_working_set_t *data_set, const char *s);
+const char *pe__interned(const pe_working_set_t *data_set, const char *s);
+
 extern void resource_location(resource_t * rsc, node_t * node, int score, const char *tag,
                               pe_working_set_t * data_set);
 
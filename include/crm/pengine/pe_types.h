@@ -176,6 +176,18 @@ struct pe_working_set_s {
     time_t recheck_by;  // Hint to controller to re-run scheduler by this time
     int ninstances;     // Total number of resource instances
     guint shutdown_lock;// How long (seconds) to lock resources to shutdown node
+
+    //! Action key -> list of saved pe_action_t* with that key (newest first)
+    GHashTable *action_index;
+
+    //! Utilization attribute names, in numeric utilization vector order
+    GPtrArray *utilization_names;
+
+    //! Region allocator for objects freed along with the working set
+    struct pe__arena_s *arena;
+
+    //! Canonical copies of action identifiers (allocated from arena)
+    GHashTable *interned;
 };
 
 enum pe_check_parameters {
@@ -220,6 +232,9 @@ struct pe_node_shared_s {
     GHashTable *attrs;          /* char* => char* */
     GHashTable *utilization;
     GHashTable *digest_cache;   //!< cache of calculated resource digests
+
+    //! Numeric form of utilization (scheduler use only, free() when done)
+    struct pcmk__utilization_s *utilization_values;
 };
 
 struct pe_node_s {
@@ -369,6 +384,9 @@ struct pe_resource_s {
 #if ENABLE_VERSIONED_ATTRS
     xmlNode *versioned_parameters;
 #endif
+
+    //! Numeric form of utilization (scheduler use only, free() when done)
+    struct pcmk__utilization_s *utilization_values;
 };
 
 #if ENABLE_VERSIONED_ATTRS
@@ -427,6 +445,12 @@ struct pe_action_s {
      * except for API backward compatibility.
      */
     void *action_details; // varies by type of action
+
+    //! Action -> list of its wrappers in actions_after (only if list is long)
+    GHashTable *after_index;
+
+    //! Arena this action and its wrappers were allocated from (if any)
+    struct pe__arena_s *arena;
 };
 
 typedef struct pe_ticket_s {
@@ -300,6 +300,7 @@ gboolean services_action_kick(const char *name, const char *action,
     void services_action_cleanup(svc_action_t * op);
     void services_action_free(svc_action_t * op);
     int services_action_user(svc_action_t *op, const char *user);
+    void services_action_set_output_max(svc_action_t *op, size_t max_bytes);
 
     gboolean services_action_sync(svc_action_t * op);
 
@@ -71,9 +71,23 @@ extern enum filter_colocation_res
 filter_colocation_constraint(resource_t * rsc_lh, resource_t * rsc_rh,
                              rsc_colocation_t * constraint, gboolean preview);
 
+/* Numeric utilization values, indexed like data_set->utilization_names (an
+ * attribute that is not set has value 0)
+ */
+typedef struct pcmk__utilization_s {
+    int count;                  // Number of attributes in vector
+    struct {
+        long long value;
+        bool set;               // Whether attribute has a value
+    } attrs[];
+} pcmk__utilization_t;
+
+void pcmk__unpack_utilization(pe_working_set_t *data_set);
+void pcmk__sync_utilization(pe_node_t *node, pe_working_set_t *data_set);
+
 extern int compare_capacity(const node_t * node1, const node_t * node2);
-extern void calculate_utilization(GHashTable * current_utilization,
-                                  GHashTable * utilization, gboolean plus);
+extern void calculate_utilization(pe_node_t *node, pe_resource_t *rsc,
+                                  gboolean plus);
 
 extern void process_utilization(resource_t * rsc, node_t ** prefer, pe_working_set_t * data_set);
 pe_action_t *create_pseudo_resource_op(resource_t * rsc, const char *task, bool optional, bool runnable, pe_working_set_t *data_set);
@@ -39,6 +39,8 @@ typedef struct synapse_s {
 
     GListPtr actions;           /* crm_action_t* */
     GListPtr inputs;            /* crm_action_t* */
+
+    int pending_inputs;         // Number of inputs not yet confirmed
 } synapse_t;
 
 typedef struct crm_action_s {
@@ -101,6 +103,10 @@ struct crm_graph_s {
     GListPtr synapses;          /* synapse_t* */
 
     int migration_limit;
+
+    GHashTable *owners;         // Action ID -> synapse_t* containing action
+    GHashTable *dependents;     // Action ID -> list of inputs with that ID
+    GListPtr ready;             // synapse_t* with all inputs confirmed, by ID
 };
 
 typedef struct crm_graph_functions_s {
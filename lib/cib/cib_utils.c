@@ -22,6 +22,7 @@
 #include <crm/msg_xml.h>
 #include <crm/common/iso8601_internal.h>
 #include <crm/common/xml.h>
+#include <crm/common/xml_internal.h>
 #include <crm/pengine/rules.h>
 
 struct config_root_s {
@@ -209,6 +210,7 @@ cib_perform_op(const char *op, int call_options, cib_op_t * fn, gboolean is_quer
 {
     int rc = pcmk_ok;
     gboolean check_schema = TRUE;
+    bool status_only = false;
     xmlNode *top = NULL;
     xmlNode *scratch = NULL;
     xmlNode *local_diff = NULL;
@@ -378,6 +380,11 @@ cib_perform_op(const char *op, int call_options, cib_op_t * fn, gboolean is_quer
         local_diff = xml_create_patchset(0, current_cib, scratch, (bool*)config_changed, manage_counters);
     }
 
+    /* Must be checked before the changes are accepted (and before the
+     * bookkeeping attributes below are added)
+     */
+    status_only = pcmk__xml_status_only_changes(scratch);
+
     xml_log_changes(LOG_TRACE, __FUNCTION__, scratch);
     xml_accept_changes(scratch);
 
@@ -419,6 +426,26 @@ cib_perform_op(const char *op, int call_options, cib_op_t * fn, gboolean is_quer
          * b) we don't validate any of its contents at the moment anyway
          */
         check_schema = FALSE;
+
+    } else if (status_only) {
+        /* The schema allows anything beneath status, so changes confined to it
+         * can't invalidate the CIB. Still do a full validation occasionally,
+         * as a safety net, but only complain since the status update itself
+         * is not to blame for any problem found.
+         */
+        static time_t full_validation_due = 0;
+        time_t tm_now = time(NULL);
+
+        check_schema = FALSE;
+        if (full_validation_due < tm_now) {
+            full_validation_due = tm_now + 60;
+            if (!validate_xml(scratch, NULL, TRUE)) {
+                crm_err("CIB does not validate against %s schema "
+                        "(detected during status update)",
+                        crm_str(crm_element_value(scratch,
+                                                  XML_ATTR_VALIDATION)));
+            }
+        }
     }
 
     /* === scratch must not be modified after this point ===
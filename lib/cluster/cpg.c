@@ -8,7 +8,6 @@
  */
 
 #include <crm_internal.h>
-#include <bzlib.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -30,6 +29,7 @@
 #include <crm/msg_xml.h>
 
 #include <crm/common/ipc_internal.h>  /* PCMK__SPECIAL_PID* */
+#include <crm/common/xml_internal.h>  // pcmk__xml_serialize()
 
 cpg_handle_t pcmk_cpg_handle = 0; /* TODO: Remove, use cluster.cpg_handle */
 
@@ -130,8 +130,19 @@ bail:
 }
 
 
-GListPtr cs_message_queue = NULL;
-int cs_message_timer = 0;
+// Messages waiting to be sent (struct iovec *), oldest first
+static GQueue *cs_message_queue = NULL;
+static guint cs_message_timer = 0;
+
+/* Backpressure statistics, reported when corosync stops accepting messages
+ * and again when it recovers
+ */
+static struct {
+    gint64 blocked_since;       // Monotonic time sending first failed (or 0)
+    guint retry_ms;             // Current delay before retrying
+    unsigned int retries;       // Failed attempts since blocked_since
+    unsigned int peak;          // Longest queue since blocked_since
+} cs_backpressure = { 0, 0, 0, 0 };
 
 static ssize_t crm_cs_flush(gpointer data);
 
@@ -143,13 +154,19 @@ crm_cs_flush_cb(gpointer data)
     return FALSE;
 }
 
+// Send at most this many messages per main loop iteration
 #define CS_SEND_MAX 200
+
+// Bounds on the delay between attempts when corosync is congested
+#define CS_RETRY_MIN_MS 10
+#define CS_RETRY_MAX_MS 1000
+
 static ssize_t
 crm_cs_flush(gpointer data)
 {
     int sent = 0;
     ssize_t rc = 0;
-    int queue_len = 0;
+    guint queue_len = 0;
     static unsigned int last_sent = 0;
     cpg_handle_t *handle = (cpg_handle_t *)data;
 
@@ -158,22 +175,22 @@ crm_cs_flush(gpointer data)
         return pcmk_ok;
     }
 
-    queue_len = g_list_length(cs_message_queue);
+    queue_len = (cs_message_queue == NULL)? 0 : g_queue_get_length(cs_message_queue);
     if ((queue_len % 1000) == 0 && queue_len > 1) {
-        crm_err("CPG queue has grown to %d", queue_len);
+        crm_err("CPG queue has grown to %u", queue_len);
 
     } else if (queue_len == CS_SEND_MAX) {
-        crm_warn("CPG queue has grown to %d", queue_len);
+        crm_warn("CPG queue has grown to %u", queue_len);
     }
 
     if (cs_message_timer) {
         /* There is already a timer, wait until it goes off */
-        crm_trace("Timer active %d", cs_message_timer);
+        crm_trace("Timer active %u", cs_message_timer);
         return pcmk_ok;
     }
 
-    while (cs_message_queue && sent < CS_SEND_MAX) {
-        struct iovec *iov = cs_message_queue->data;
+    while ((queue_len > 0) && (sent < CS_SEND_MAX)) {
+        struct iovec *iov = g_queue_peek_head(cs_message_queue);
 
         errno = 0;
         rc = cpg_mcast_joined(*handle, CPG_TYPE_AGREED, iov, 1);
@@ -184,32 +201,61 @@ crm_cs_flush(gpointer data)
 
         sent++;
         last_sent++;
+        queue_len--;
         crm_trace("CPG message sent, size=%llu",
                   (unsigned long long) iov->iov_len);
 
-        cs_message_queue = g_list_remove(cs_message_queue, iov);
+        g_queue_pop_head(cs_message_queue);
         free(iov->iov_base);
         free(iov);
     }
 
-    queue_len -= sent;
-    if (sent > 1 || cs_message_queue) {
-        crm_info("Sent %d CPG messages  (%d remaining, last=%u): %s (%lld)",
+    if (sent > 1 || queue_len) {
+        crm_info("Sent %d CPG messages  (%u remaining, last=%u): %s (%lld)",
                  sent, queue_len, last_sent, ais_error2text(rc),
                  (long long) rc);
     } else {
-        crm_trace("Sent %d CPG messages  (%d remaining, last=%u): %s (%lld)",
+        crm_trace("Sent %d CPG messages  (%u remaining, last=%u): %s (%lld)",
                   sent, queue_len, last_sent, ais_error2text(rc),
                   (long long) rc);
     }
 
-    if (cs_message_queue) {
-        uint32_t delay_ms = 100;
-        if(rc != CS_OK) {
-            /* Proportionally more if sending failed but cap at 1s */
-            delay_ms = QB_MIN(1000, CS_SEND_MAX + (10 * queue_len));
+    if ((rc == CS_OK) && (cs_backpressure.blocked_since != 0)) {
+        crm_notice("CPG accepted messages again after %lldms "
+                   CRM_XS " retries=%u peak-queue=%u",
+                   (long long) ((g_get_monotonic_time()
+                                 - cs_backpressure.blocked_since) / 1000),
+                   cs_backpressure.retries, cs_backpressure.peak);
+        cs_backpressure.blocked_since = 0;
+        cs_backpressure.retries = 0;
+        cs_backpressure.peak = 0;
+    }
+
+    if (queue_len == 0) {
+        // Nothing to do
+
+    } else if (rc == CS_OK) {
+        /* We stopped only to let other main loop sources run, so continue as
+         * soon as they have had their turn
+         */
+        cs_message_timer = g_idle_add_full(G_PRIORITY_DEFAULT, crm_cs_flush_cb,
+                                           data, NULL);
+
+    } else {
+        // Back off exponentially while corosync is congested
+        if (cs_backpressure.blocked_since == 0) {
+            cs_backpressure.blocked_since = g_get_monotonic_time();
+            cs_backpressure.retry_ms = CS_RETRY_MIN_MS;
+            cs_backpressure.peak = queue_len;
+            crm_info("CPG is not accepting messages (%s), queueing %u",
+                     ais_error2text(rc), queue_len);
+        } else {
+            cs_backpressure.retry_ms = QB_MIN(CS_RETRY_MAX_MS,
+                                              2 * cs_backpressure.retry_ms);
         }
-        cs_message_timer = g_timeout_add(delay_ms, crm_cs_flush_cb, data);
+        cs_backpressure.retries++;
+        cs_message_timer = g_timeout_add(cs_backpressure.retry_ms,
+                                         crm_cs_flush_cb, data);
     }
 
     return rc;
@@ -220,10 +266,18 @@ send_cpg_iov(struct iovec * iov)
 {
     static unsigned int queued = 0;
 
+    if (cs_message_queue == NULL) {
+        cs_message_queue = g_queue_new();
+    }
+
     queued++;
     crm_trace("Queueing CPG message %u (%llu bytes)",
               queued, (unsigned long long) iov->iov_len);
-    cs_message_queue = g_list_append(cs_message_queue, iov);
+    g_queue_push_tail(cs_message_queue, iov);
+    if (cs_backpressure.blocked_since != 0) {
+        cs_backpressure.peak = QB_MAX(cs_backpressure.peak,
+                                      g_queue_get_length(cs_message_queue));
+    }
     crm_cs_flush(&pcmk_cpg_handle);
     return TRUE;
 }
@@ -304,7 +358,6 @@ pcmk_message_common_cs(cpg_handle_t handle, uint32_t nodeid, uint32_t pid, void
     }
 
     if (msg->is_compressed && msg->size > 0) {
-        int rc = BZ_OK;
         char *uncompressed = NULL;
         unsigned int new_size = msg->size + 1;
 
@@ -312,18 +365,17 @@ pcmk_message_common_cs(cpg_handle_t handle, uint32_t nodeid, uint32_t pid, void
             goto badmsg;
         }
 
-        crm_trace("Decompressing message data");
+        /* Older nodes always set is_compressed to TRUE (which is also the
+         * bzip2 codec value), while newer nodes set it to the codec used
+         */
         uncompressed = calloc(1, new_size);
-        rc = BZ2_bzBuffToBuffDecompress(uncompressed, &new_size, msg->data, msg->compressed_size, 1, 0);
-
-        if (rc != BZ_OK) {
-            crm_err("Decompression failed: %s " CRM_XS " bzerror=%d",
-                    bz2_strerror(rc), rc);
+        if (pcmk__decompress((enum pcmk__codec) msg->is_compressed, msg->data,
+                             msg->compressed_size, uncompressed,
+                             &new_size) != pcmk_rc_ok) {
             free(uncompressed);
             goto badmsg;
         }
 
-        CRM_ASSERT(rc == BZ_OK);
         CRM_ASSERT(new_size == msg->size);
 
         data = uncompressed;
@@ -629,21 +681,93 @@ cluster_connect_cpg(crm_cluster_t *cluster)
     return TRUE;
 }
 
+/*!
+ * \internal
+ * \brief Get the codec to use for compressing large cluster messages
+ *
+ * Peers running older versions can only decompress bzip2, so zstd is used
+ * only when the administrator has opted in via PCMK_cluster_compression
+ * (which should be done only once all nodes have been upgraded).
+ *
+ * \return Codec to use for cluster messages
+ */
+static enum pcmk__codec
+cluster_codec(void)
+{
+    static enum pcmk__codec codec = pcmk__codec_none;
+
+    if (codec == pcmk__codec_none) {
+        const char *value = pcmk__env_option("cluster_compression");
+
+        codec = pcmk__codec_bzip2;
+        if (safe_str_eq(value, "zstd")) {
+            if (pcmk__codec_supported(pcmk__codec_zstd)) {
+                codec = pcmk__codec_zstd;
+            } else {
+                crm_warn("Using bzip2 for cluster messages because this "
+                         "build does not support zstd");
+            }
+        } else if ((value != NULL) && safe_str_neq(value, "bzip2")) {
+            crm_warn("Ignoring invalid value '%s' for PCMK_cluster_compression",
+                     value);
+        }
+        crm_debug("Compressing large cluster messages with %s",
+                  pcmk__codec_text(codec));
+    }
+    return codec;
+}
+
+static gboolean send_cpg_text(enum crm_ais_msg_class msg_class,
+                              const char *data, size_t length, gboolean local,
+                              crm_node_t *node, enum crm_ais_msg_types dest);
+
 gboolean
 send_cluster_message_cs(xmlNode * msg, gboolean local, crm_node_t * node, enum crm_ais_msg_types dest)
 {
     gboolean rc = TRUE;
-    char *data = NULL;
 
-    data = dump_xml_unformatted(msg);
-    rc = send_cluster_text(crm_class_cluster, data, local, node, dest);
-    free(data);
+    /* The text is copied into the CPG message before we return, so serialize
+     * into the same buffer every time rather than allocating one per message
+     */
+    static pcmk__xml_buf_t buffer = { NULL, 0, 0 };
+
+    if (pcmk__xml_serialize(msg, &buffer) == NULL) {
+        rc = send_cpg_text(crm_class_cluster, "", 0, local, node, dest);
+    } else {
+        rc = send_cpg_text(crm_class_cluster, buffer.str, buffer.len, local,
+                           node, dest);
+    }
+    pcmk__xml_buf_done(&buffer);
     return rc;
 }
 
 gboolean
 send_cluster_text(enum crm_ais_msg_class msg_class, const char *data,
                   gboolean local, crm_node_t *node, enum crm_ais_msg_types dest)
+{
+    if (data == NULL) {
+        data = "";
+    }
+    return send_cpg_text(msg_class, data, strlen(data), local, node, dest);
+}
+
+/*!
+ * \internal
+ * \brief Queue text of known length for sending to cluster peers
+ *
+ * \param[in] msg_class  Message class
+ * \param[in] data       NUL-terminated text to send
+ * \param[in] length     Length of \p data (not including NUL)
+ * \param[in] local      Whether message is for local node's peers only
+ * \param[in] node       Cluster node to send message to (NULL for all)
+ * \param[in] dest       Type of message recipient
+ *
+ * \return TRUE on success, otherwise FALSE
+ */
+static gboolean
+send_cpg_text(enum crm_ais_msg_class msg_class, const char *data,
+              size_t length, gboolean local, crm_node_t *node,
+              enum crm_ais_msg_types dest)
 {
     static int msg_id = 0;
     static int local_pid = 0;
@@ -672,10 +796,6 @@ send_cluster_text(enum crm_ais_msg_class msg_class, const char *data,
         local_name_len = strlen(local_name);
     }
 
-    if (data == NULL) {
-        data = "";
-    }
-
     if (local_pid == 0) {
         local_pid = getpid();
     }
@@ -717,7 +837,7 @@ send_cluster_text(enum crm_ais_msg_class msg_class, const char *data,
         memcpy(msg->sender.uname, local_name, msg->sender.size);
     }
 
-    msg->size = 1 + strlen(data);
+    msg->size = 1 + length;
     msg->header.size = sizeof(AIS_Message) + msg->size;
 
     if (msg->size < CRM_BZ2_THRESHOLD) {
@@ -727,15 +847,16 @@ send_cluster_text(enum crm_ais_msg_class msg_class, const char *data,
     } else {
         char *compressed = NULL;
         unsigned int new_size = 0;
-        char *uncompressed = strdup(data);
+        enum pcmk__codec codec = cluster_codec();
 
-        if (crm_compress_string(uncompressed, msg->size, 0, &compressed, &new_size)) {
+        if (pcmk__compress(codec, data, msg->size, 0, &compressed,
+                           &new_size)) {
 
             msg->header.size = sizeof(AIS_Message) + new_size;
             msg = realloc_safe(msg, msg->header.size);
             memcpy(msg->data, compressed, new_size);
 
-            msg->is_compressed = TRUE;
+            msg->is_compressed = codec;
             msg->compressed_size = new_size;
 
         } else {
@@ -743,7 +864,6 @@ send_cluster_text(enum crm_ais_msg_class msg_class, const char *data,
             memcpy(msg->data, data, msg->size);
         }
 
-        free(uncompressed);
         free(compressed);
     }
 
@@ -52,6 +52,16 @@ GHashTable *crm_remote_peer_cache = NULL;
 
 GHashTable *crm_known_peer_cache = NULL;
 
+/* Secondary indexes of crm_peer_cache by node ID and (case-insensitive) uname,
+ * so that crm_find_peer() does not need to scan the whole cache. Values are
+ * borrowed from crm_peer_cache. If IDs or names collide, only one entry is
+ * indexed, so whenever an indexed entry is removed from the cache, the indexes
+ * are marked stale and rebuilt by the next lookup.
+ */
+static GHashTable *peers_by_id = NULL;
+static GHashTable *peers_by_name = NULL;
+static gboolean peer_index_stale = FALSE;
+
 unsigned long long crm_peer_seq = 0;
 gboolean crm_have_quorum = FALSE;
 static gboolean crm_autoreap  = TRUE;
@@ -372,6 +382,61 @@ crm_active_peers(void)
     return count;
 }
 
+/*!
+ * \internal
+ * \brief Add a cluster peer cache entry to the ID and name indexes
+ *
+ * \param[in] node  Peer cache entry to index
+ */
+static void
+index_peer(crm_node_t *node)
+{
+    if ((peers_by_id == NULL) || is_set(node->flags, crm_remote_node)) {
+        return;
+    }
+    if (node->id > 0) {
+        g_hash_table_replace(peers_by_id, GUINT_TO_POINTER(node->id), node);
+    }
+    if (node->uname != NULL) {
+        g_hash_table_replace(peers_by_name, strdup(node->uname), node);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Rebuild the peer cache indexes if any indexed entry has been removed
+ */
+static void
+refresh_peer_index(void)
+{
+    GHashTableIter iter;
+    crm_node_t *node = NULL;
+
+    if (!peer_index_stale) {
+        return;
+    }
+
+    crm_trace("Rebuilding peer cache indexes for %d members",
+              g_hash_table_size(crm_peer_cache));
+    g_hash_table_remove_all(peers_by_id);
+    g_hash_table_remove_all(peers_by_name);
+
+    /* Where entries collide, keep the first one seen, as a cache scan would */
+    g_hash_table_iter_init(&iter, crm_peer_cache);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &node)) {
+        if ((node->id > 0)
+            && (g_hash_table_lookup(peers_by_id,
+                                    GUINT_TO_POINTER(node->id)) == NULL)) {
+            g_hash_table_insert(peers_by_id, GUINT_TO_POINTER(node->id), node);
+        }
+        if ((node->uname != NULL)
+            && (g_hash_table_lookup(peers_by_name, node->uname) == NULL)) {
+            g_hash_table_insert(peers_by_name, strdup(node->uname), node);
+        }
+    }
+    peer_index_stale = FALSE;
+}
+
 static void
 destroy_crm_node(gpointer data)
 {
@@ -379,6 +444,16 @@ destroy_crm_node(gpointer data)
 
     crm_trace("Destroying entry for node %u: %s", node->id, node->uname);
 
+    if ((peers_by_id != NULL) && !peer_index_stale
+        && (((node->id > 0)
+             && (g_hash_table_lookup(peers_by_id,
+                                     GUINT_TO_POINTER(node->id)) == node))
+            || ((node->uname != NULL)
+                && (g_hash_table_lookup(peers_by_name, node->uname) == node)))) {
+        /* Another entry with the same ID or name may still be cached */
+        peer_index_stale = TRUE;
+    }
+
     free(node->uname);
     free(node->state);
     free(node->uuid);
@@ -400,6 +475,12 @@ crm_peer_init(void)
     if (crm_known_peer_cache == NULL) {
         crm_known_peer_cache = g_hash_table_new_full(crm_strcase_hash, crm_strcase_equal, free, destroy_crm_node);
     }
+
+    if (peers_by_id == NULL) {
+        peers_by_id = g_hash_table_new(g_direct_hash, g_direct_equal);
+        peers_by_name = g_hash_table_new_full(crm_strcase_hash,
+                                              crm_strcase_equal, free, NULL);
+    }
 }
 
 void
@@ -423,6 +504,13 @@ crm_peer_destroy(void)
         crm_known_peer_cache = NULL;
     }
 
+    if (peers_by_id != NULL) {
+        g_hash_table_destroy(peers_by_id);
+        g_hash_table_destroy(peers_by_name);
+        peers_by_id = NULL;
+        peers_by_name = NULL;
+        peer_index_stale = FALSE;
+    }
 }
 
 void (*crm_status_callback) (enum crm_status_type, crm_node_t *, const void *) = NULL;
@@ -521,7 +609,6 @@ crm_get_peer_full(unsigned int id, const char *uname, int flags)
 crm_node_t *
 crm_find_peer(unsigned int id, const char *uname)
 {
-    GHashTableIter iter;
     crm_node_t *node = NULL;
     crm_node_t *by_id = NULL;
     crm_node_t *by_name = NULL;
@@ -529,26 +616,19 @@ crm_find_peer(unsigned int id, const char *uname)
     CRM_ASSERT(id > 0 || uname != NULL);
 
     crm_peer_init();
+    refresh_peer_index();
 
     if (uname != NULL) {
-        g_hash_table_iter_init(&iter, crm_peer_cache);
-        while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &node)) {
-            if(node->uname && strcasecmp(node->uname, uname) == 0) {
-                crm_trace("Name match: %s = %p", node->uname, node);
-                by_name = node;
-                break;
-            }
+        by_name = g_hash_table_lookup(peers_by_name, uname);
+        if (by_name) {
+            crm_trace("Name match: %s = %p", by_name->uname, by_name);
         }
     }
 
     if (id > 0) {
-        g_hash_table_iter_init(&iter, crm_peer_cache);
-        while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &node)) {
-            if(node->id == id) {
-                crm_trace("ID match: %u = %p", node->id, node);
-                by_id = node;
-                break;
-            }
+        by_id = g_hash_table_lookup(peers_by_id, GUINT_TO_POINTER(id));
+        if (by_id) {
+            crm_trace("ID match: %u = %p", by_id->id, by_id);
         }
     }
 
@@ -695,6 +775,7 @@ crm_get_peer(unsigned int id, const char *uname)
 
     if(id > 0 && node->id == 0) {
         node->id = id;
+        index_peer(node);
     }
 
     if (uname && (node->uname == NULL)) {
@@ -750,9 +831,16 @@ crm_update_peer_uname(crm_node_t *node, const char *uname)
         }
     }
 
+    if ((node->uname != NULL) && (peers_by_name != NULL)
+        && (g_hash_table_lookup(peers_by_name, node->uname) == node)) {
+        // Another entry may share the old name
+        peer_index_stale = TRUE;
+    }
+
     free(node->uname);
     node->uname = strdup(uname);
     CRM_ASSERT(node->uname != NULL);
+    index_peer(node);
 
     if (crm_status_callback) {
         crm_status_callback(crm_status_uname, node, NULL);
@@ -73,6 +73,9 @@ void pcmk__apply_creation_acl(xmlNode *xml, bool check_top);
 G_GNUC_INTERNAL
 void pcmk__mark_xml_attr_dirty(xmlAttr *a);
 
+G_GNUC_INTERNAL
+void pcmk__xpath_cleanup(void);
+
 static inline xmlAttr *
 pcmk__first_xml_attr(const xmlNode *xml)
 {
@@ -107,7 +107,8 @@ pcmk__real_path(const char *path, char **resolved_path)
  * \param[in] directory  Directory that contains the file series
  * \param[in] series     Start of file name
  * \param[in] sequence   Sequence number
- * \param[in] bzip       Whether to use ".bz2" instead of ".raw" as extension
+ * \param[in] bzip       Whether to use the compressed file extension (".bz2",
+ *                       or ".zst" if zstd was selected) instead of ".raw"
  *
  * \return Newly allocated file path (asserts on error, so always non-NULL)
  * \note The caller is responsible for freeing the return value.
@@ -118,7 +119,7 @@ pcmk__series_filename(const char *directory, const char *series, int sequence,
 {
     CRM_ASSERT((directory != NULL) && (series != NULL));
     return crm_strdup_printf("%s/%s-%d.%s", directory, series, sequence,
-                             (bzip? "bz2" : "raw"));
+                             (bzip? pcmk__compressed_file_ext() : "raw"));
 }
 
 /*!
@@ -30,7 +30,6 @@
 
 #include <errno.h>
 #include <fcntl.h>
-#include <bzlib.h>
 
 #include <crm/crm.h>   /* indirectly: pcmk_err_generic */
 #include <crm/msg_xml.h>
@@ -38,6 +37,7 @@
 #include <crm/common/ipcs_internal.h>
 
 #include <crm/common/ipc_internal.h>  /* PCMK__SPECIAL_PID* */
+#include <crm/common/xml_internal.h>  // pcmk__xml_serialize(), etc.
 
 #define PCMK_IPC_VERSION 1
 
@@ -52,6 +52,14 @@ struct crm_ipc_response_header {
     uint8_t  version; /* Protect against version changes for anyone that might bother to statically link us */
 };
 
+// Get the codec used to compress a message's payload
+static inline enum pcmk__codec
+header_codec(const struct crm_ipc_response_header *header)
+{
+    return is_set(header->flags, crm_ipc_compressed_zstd)?
+           pcmk__codec_zstd : pcmk__codec_bzip2;
+}
+
 static int hdr_offset = 0;
 static unsigned int ipc_buffer_max = 0;
 static unsigned int pick_ipc_buffer(unsigned int max);
@@ -470,19 +478,108 @@ pcmk_free_ipc_event(struct iovec *event)
     }
 }
 
+// An IPC event whose payload can be queued for many clients without copying
+struct pcmk__ipc_shared_event_s {
+    struct iovec *iov;  // Prepared event (header is copied for each client)
+    int refs;           // Creator's reference plus one per queued copy
+};
+
+// An event waiting in a client's event queue
+typedef struct queued_event_s {
+    struct crm_ipc_response_header header;  // This client's copy of header
+    struct iovec iov[2];                    // Header and payload to send
+    pcmk__ipc_shared_event_t *shared;       // Payload owner (NULL if ours)
+} queued_event_t;
+
+/*!
+ * \internal
+ * \brief Create a shareable IPC event from a prepared I/O vector
+ *
+ * \param[in] iov  I/O vector created by pcmk__ipc_prepare_iov() (this takes
+ *                 ownership of it)
+ *
+ * \return Newly allocated shared event, with one reference held by the caller
+ * \note The caller should release its reference with
+ *       pcmk__ipc_unref_shared_event() once it has been sent to all clients.
+ */
+pcmk__ipc_shared_event_t *
+pcmk__ipc_new_shared_event(struct iovec *iov)
+{
+    pcmk__ipc_shared_event_t *event = NULL;
+
+    CRM_CHECK(iov != NULL, return NULL);
+
+    event = calloc(1, sizeof(pcmk__ipc_shared_event_t));
+    CRM_ASSERT(event != NULL);
+    event->iov = iov;
+    event->refs = 1;
+    return event;
+}
+
+/*!
+ * \internal
+ * \brief Release a reference to a shared IPC event
+ *
+ * \param[in] event  Shared event to release (freed with its last reference)
+ */
+void
+pcmk__ipc_unref_shared_event(pcmk__ipc_shared_event_t *event)
+{
+    if (event != NULL) {
+        CRM_LOG_ASSERT(event->refs > 0);
+        if (--(event->refs) <= 0) {
+            pcmk_free_ipc_event(event->iov);
+            free(event);
+        }
+    }
+}
+
 static void
 free_event(gpointer data)
 {
-    pcmk_free_ipc_event((struct iovec *) data);
+    queued_event_t *event = data;
+
+    if (event->shared != NULL) {
+        pcmk__ipc_unref_shared_event(event->shared);
+    } else {
+        free(event->iov[1].iov_base);
+    }
+    free(event);
 }
 
-static void
-add_event(pcmk__client_t *c, struct iovec *iov)
+/*!
+ * \internal
+ * \brief Add an event to a client's event queue
+ *
+ * \param[in] c       Client to queue event for
+ * \param[in] iov     Event to queue (header is copied, payload is not)
+ * \param[in] shared  If not NULL, shared event that owns the payload
+ *
+ * \return Newly queued event
+ * \note If \p shared is NULL, the queued event takes ownership of the payload.
+ */
+static queued_event_t *
+add_event(pcmk__client_t *c, struct iovec *iov,
+          pcmk__ipc_shared_event_t *shared)
 {
+    queued_event_t *event = calloc(1, sizeof(queued_event_t));
+
+    CRM_ASSERT(event != NULL);
+    memcpy(&(event->header), iov[0].iov_base, sizeof(event->header));
+    event->iov[0].iov_base = &(event->header);
+    event->iov[0].iov_len = iov[0].iov_len;
+    event->iov[1] = iov[1];
+
+    if (shared != NULL) {
+        event->shared = shared;
+        shared->refs++;
+    }
+
     if (c->event_queue == NULL) {
         c->event_queue = g_queue_new();
     }
-    g_queue_push_tail(c->event_queue, iov);
+    g_queue_push_tail(c->event_queue, event);
+    return event;
 }
 
 void
@@ -583,6 +680,11 @@ pcmk__client_data2xml(pcmk__client_t *c, void *data, size_t size, uint32_t *id,
         c->flags |= pcmk__client_proxied;
     }
 
+    if (is_set(header->flags, crm_ipc_accepts_zstd)) {
+        // Compress large replies and events for this client with zstd
+        c->flags |= pcmk__client_zstd;
+    }
+
     if(header->version > PCMK_IPC_VERSION) {
         crm_err("Filtering incompatible v%d IPC message, we only support versions <= %d",
                 header->version, PCMK_IPC_VERSION);
@@ -590,22 +692,16 @@ pcmk__client_data2xml(pcmk__client_t *c, void *data, size_t size, uint32_t *id,
     }
 
     if (header->size_compressed) {
-        int rc = 0;
         unsigned int size_u = 1 + header->size_uncompressed;
         uncompressed = calloc(1, size_u);
 
-        crm_trace("Decompressing message data %u bytes into %u bytes",
-                  header->size_compressed, size_u);
-
-        rc = BZ2_bzBuffToBuffDecompress(uncompressed, &size_u, text, header->size_compressed, 1, 0);
-        text = uncompressed;
-
-        if (rc != BZ_OK) {
-            crm_err("Decompression failed: %s " CRM_XS " bzerror=%d",
-                    bz2_strerror(rc), rc);
+        if (pcmk__decompress(header_codec(header), text,
+                             header->size_compressed, uncompressed,
+                             &size_u) != pcmk_rc_ok) {
             free(uncompressed);
             return NULL;
         }
+        text = uncompressed;
     }
 
     CRM_ASSERT(text[header->size_uncompressed - 1] == 0);
@@ -675,7 +771,7 @@ crm_ipcs_flush_events(pcmk__client_t *c)
     }
     while (sent < 100) {
         struct crm_ipc_response_header *header = NULL;
-        struct iovec *event = NULL;
+        queued_event_t *event = NULL;
 
         if (c->event_queue) {
             // We don't pop unless send is successful
@@ -685,7 +781,7 @@ crm_ipcs_flush_events(pcmk__client_t *c)
             break;
         }
 
-        qb_rc = qb_ipcs_event_sendv(c->ipcs, event, 2);
+        qb_rc = qb_ipcs_event_sendv(c->ipcs, event->iov, 2);
         if (qb_rc < 0) {
             rc = (int) -qb_rc;
             break;
@@ -693,16 +789,16 @@ crm_ipcs_flush_events(pcmk__client_t *c)
         event = g_queue_pop_head(c->event_queue);
 
         sent++;
-        header = event[0].iov_base;
+        header = &(event->header);
         if (header->size_compressed) {
             crm_trace("Event %d to %p[%d] (%lld compressed bytes) sent",
                       header->qb.id, c->ipcs, c->pid, (long long) qb_rc);
         } else {
             crm_trace("Event %d to %p[%d] (%lld bytes) sent: %.120s",
                       header->qb.id, c->ipcs, c->pid, (long long) qb_rc,
-                      (char *) (event[1].iov_base));
+                      (char *) (event->iov[1].iov_base));
         }
-        pcmk_free_ipc_event(event);
+        free_event(event);
     }
 
     queue_len -= sent;
@@ -750,6 +846,7 @@ crm_ipcs_flush_events(pcmk__client_t *c)
  * \param[in]  request        Identifier for libqb response header
  * \param[in]  message        XML message to send
  * \param[in]  max_send_size  If 0, default IPC buffer size is used
+ * \param[in]  codec          Codec to use if message must be compressed
  * \param[out] result         Where to store prepared I/O vector
  * \param[out] bytes          Size of prepared data in bytes
  *
@@ -757,14 +854,14 @@ crm_ipcs_flush_events(pcmk__client_t *c)
  */
 int
 pcmk__ipc_prepare_iov(uint32_t request, xmlNode *message,
-                      uint32_t max_send_size, struct iovec **result,
-                      ssize_t *bytes)
+                      uint32_t max_send_size, enum pcmk__codec codec,
+                      struct iovec **result, ssize_t *bytes)
 {
     static unsigned int biggest = 0;
     struct iovec *iov;
     unsigned int total = 0;
     char *compressed = NULL;
-    char *buffer = NULL;
+    pcmk__xml_buf_t buffer = { NULL, 0, 0 };
     struct crm_ipc_response_header *header = NULL;
 
     if ((message == NULL) || (result == NULL)) {
@@ -776,7 +873,10 @@ pcmk__ipc_prepare_iov(uint32_t request, xmlNode *message,
         return errno;
     }
 
-    buffer = dump_xml_unformatted(message);
+    /* Serialize directly into what will become the payload (if it doesn't
+     * need compression), tracking the length as we go
+     */
+    pcmk__xml_serialize(message, &buffer);
     crm_ipc_init();
 
     if (max_send_size == 0) {
@@ -790,26 +890,29 @@ pcmk__ipc_prepare_iov(uint32_t request, xmlNode *message,
     iov[0].iov_base = header;
 
     header->version = PCMK_IPC_VERSION;
-    header->size_uncompressed = 1 + strlen(buffer);
+    header->size_uncompressed = 1 + buffer.len;
     total = iov[0].iov_len + header->size_uncompressed;
 
     if (total < max_send_size) {
-        iov[1].iov_base = buffer;
+        iov[1].iov_base = pcmk__xml_buf_steal(&buffer);
         iov[1].iov_len = header->size_uncompressed;
 
     } else {
         unsigned int new_size = 0;
 
-        if (crm_compress_string
-            (buffer, header->size_uncompressed, max_send_size, &compressed, &new_size)) {
+        if (pcmk__compress(codec, buffer.str, header->size_uncompressed,
+                           max_send_size, &compressed, &new_size)) {
 
             header->flags |= crm_ipc_compressed;
+            if (codec == pcmk__codec_zstd) {
+                header->flags |= crm_ipc_compressed_zstd;
+            }
             header->size_compressed = new_size;
 
             iov[1].iov_len = header->size_compressed;
             iov[1].iov_base = compressed;
 
-            free(buffer);
+            free(buffer.str);
 
             biggest = QB_MAX(header->size_compressed, biggest);
 
@@ -823,7 +926,7 @@ pcmk__ipc_prepare_iov(uint32_t request, xmlNode *message,
                     header->size_uncompressed, max_send_size, 4 * biggest);
 
             free(compressed);
-            free(buffer);
+            free(buffer.str);
             pcmk_free_ipc_event(iov);
             return EMSGSIZE;
         }
@@ -840,11 +943,13 @@ pcmk__ipc_prepare_iov(uint32_t request, xmlNode *message,
     return pcmk_rc_ok;
 }
 
+// Event IDs aren't really used, but it doesn't hurt to set one
+static uint32_t event_id = 1;
+
 int
 pcmk__ipc_send_iov(pcmk__client_t *c, struct iovec *iov, uint32_t flags)
 {
     int rc = pcmk_rc_ok;
-    static uint32_t id = 1;
     struct crm_ipc_response_header *header = iov[0].iov_base;
 
     if (c->flags & pcmk__client_proxied) {
@@ -859,25 +964,21 @@ pcmk__ipc_send_iov(pcmk__client_t *c, struct iovec *iov, uint32_t flags)
 
     header->flags |= flags;
     if (flags & crm_ipc_server_event) {
-        header->qb.id = id++;   /* We don't really use it, but doesn't hurt to set one */
+        header->qb.id = event_id++;
 
         if (flags & crm_ipc_server_free) {
             crm_trace("Sending the original to %p[%d]", c->ipcs, c->pid);
-            add_event(c, iov);
+            add_event(c, iov, NULL);
+            free(iov[0].iov_base);
+            free(iov);
 
         } else {
-            struct iovec *iov_copy = pcmk__new_ipc_event();
+            queued_event_t *event = add_event(c, iov, NULL);
 
             crm_trace("Sending a copy to %p[%d]", c->ipcs, c->pid);
-            iov_copy[0].iov_len = iov[0].iov_len;
-            iov_copy[0].iov_base = malloc(iov[0].iov_len);
-            memcpy(iov_copy[0].iov_base, iov[0].iov_base, iov[0].iov_len);
-
-            iov_copy[1].iov_len = iov[1].iov_len;
-            iov_copy[1].iov_base = malloc(iov[1].iov_len);
-            memcpy(iov_copy[1].iov_base, iov[1].iov_base, iov[1].iov_len);
-
-            add_event(c, iov_copy);
+            event->iov[1].iov_base = malloc(iov[1].iov_len);
+            CRM_ASSERT(event->iov[1].iov_base != NULL);
+            memcpy(event->iov[1].iov_base, iov[1].iov_base, iov[1].iov_len);
         }
 
     } else {
@@ -917,6 +1018,44 @@ pcmk__ipc_send_iov(pcmk__client_t *c, struct iovec *iov, uint32_t flags)
     return rc;
 }
 
+/*!
+ * \internal
+ * \brief Queue a shared IPC event for a client and send what is possible
+ *
+ * Unlike pcmk__ipc_send_iov() without crm_ipc_server_free, this does not copy
+ * the event payload, so the same serialized message can be broadcast to any
+ * number of clients. The payload is freed when the last reference is released.
+ *
+ * \param[in] c      Client to send event to
+ * \param[in] event  Shared event to send
+ * \param[in] flags  Group of crm_ipc_flags (crm_ipc_server_event is implied)
+ *
+ * \return Standard Pacemaker return code
+ */
+int
+pcmk__ipc_send_shared_event(pcmk__client_t *c, pcmk__ipc_shared_event_t *event,
+                            uint32_t flags)
+{
+    int rc = pcmk_rc_ok;
+    queued_event_t *queued = NULL;
+
+    if ((c == NULL) || (event == NULL)) {
+        return EINVAL;
+    }
+
+    // Only this client's copy of the header is changed
+    queued = add_event(c, event->iov, event);
+    queued->header.flags |= flags | crm_ipc_server_event;
+    queued->header.qb.id = event_id++;
+    crm_trace("Sending a shared event to %p[%d]", c->ipcs, c->pid);
+
+    rc = crm_ipcs_flush_events(c);
+    if ((rc == EPIPE) || (rc == ENOTCONN)) {
+        crm_trace("Client %p disconnected", c->ipcs);
+    }
+    return rc;
+}
+
 int
 pcmk__ipc_send_xml(pcmk__client_t *c, uint32_t request, xmlNode *message,
                    uint32_t flags)
@@ -928,7 +1067,11 @@ pcmk__ipc_send_xml(pcmk__client_t *c, uint32_t request, xmlNode *message,
         return EINVAL;
     }
     crm_ipc_init();
-    rc = pcmk__ipc_prepare_iov(request, message, ipc_buffer_max, &iov, NULL);
+    rc = pcmk__ipc_prepare_iov(request, message, ipc_buffer_max,
+                               (is_set(c->flags, pcmk__client_zstd)
+                                && pcmk__codec_supported(pcmk__codec_zstd))?
+                               pcmk__codec_zstd : pcmk__codec_bzip2,
+                               &iov, NULL);
     if (rc == pcmk_rc_ok) {
         rc = pcmk__ipc_send_iov(c, iov, flags | crm_ipc_server_free);
     } else {
@@ -1201,23 +1344,19 @@ crm_ipc_decompress(crm_ipc_t * client)
     struct crm_ipc_response_header *header = (struct crm_ipc_response_header *)(void*)client->buffer;
 
     if (header->size_compressed) {
-        int rc = 0;
+        int rc = pcmk_rc_ok;
         unsigned int size_u = 1 + header->size_uncompressed;
         /* never let buf size fall below our max size required for ipc reads. */
         unsigned int new_buf_size = QB_MAX((hdr_offset + size_u), client->max_buf_size);
         char *uncompressed = calloc(1, new_buf_size);
 
-        crm_trace("Decompressing message data %u bytes into %u bytes",
-                 header->size_compressed, size_u);
-
-        rc = BZ2_bzBuffToBuffDecompress(uncompressed + hdr_offset, &size_u,
-                                        client->buffer + hdr_offset, header->size_compressed, 1, 0);
-
-        if (rc != BZ_OK) {
-            crm_err("Decompression failed: %s " CRM_XS " bzerror=%d",
-                    bz2_strerror(rc), rc);
+        rc = pcmk__decompress(header_codec(header),
+                              client->buffer + hdr_offset,
+                              header->size_compressed,
+                              uncompressed + hdr_offset, &size_u);
+        if (rc != pcmk_rc_ok) {
             free(uncompressed);
-            return EILSEQ;
+            return rc;
         }
 
         /*
@@ -1427,13 +1566,20 @@ crm_ipc_send(crm_ipc_t * client, xmlNode * message, enum crm_ipc_flags flags, in
 
     id++;
     CRM_LOG_ASSERT(id != 0); /* Crude wrap-around detection */
-    rc = pcmk__ipc_prepare_iov(id, message, client->max_buf_size, &iov, &bytes);
+    /* We don't know whether the server can decompress zstd, so use bzip2 for
+     * requests, but let the server know it can use zstd for what it sends us.
+     */
+    rc = pcmk__ipc_prepare_iov(id, message, client->max_buf_size,
+                               pcmk__codec_bzip2, &iov, &bytes);
     if (rc != pcmk_rc_ok) {
         return pcmk_rc2legacy(rc);
     }
 
     header = iov[0].iov_base;
     header->flags |= flags;
+    if (pcmk__codec_supported(pcmk__codec_zstd)) {
+        header->flags |= crm_ipc_accepts_zstd;
+    }
 
     if(is_set(flags, crm_ipc_proxied)) {
         /* Don't look for a synchronous response */
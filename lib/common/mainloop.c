@@ -20,6 +20,10 @@
 
 #include <sys/wait.h>
 
+#if HAVE_DECL_SYS_PIDFD_OPEN
+#  include <sys/syscall.h>  // SYS_pidfd_open, SYS_pidfd_send_signal
+#endif
+
 #include <crm/crm.h>
 #include <crm/common/xml.h>
 #include <crm/common/mainloop.h>
@@ -38,6 +42,9 @@ struct mainloop_child_s {
 
     /* Called when a process dies */
     void (*callback) (mainloop_child_t * p, pid_t pid, int core, int signo, int exitcode);
+
+    int pidfd;                      // Process file descriptor (or -1)
+    mainloop_io_t *pidfd_source;    // Watch for pidfd (NULL if using SIGCHLD)
 };
 
 struct trigger_s {
@@ -986,10 +993,41 @@ child_free(mainloop_child_t *child)
         g_source_remove(child->timerid);
         child->timerid = 0;
     }
+    if (child->pidfd_source != NULL) {
+        mainloop_del_fd(child->pidfd_source);
+        child->pidfd_source = NULL;
+    }
+    if (child->pidfd >= 0) {
+        close(child->pidfd);
+        child->pidfd = -1;
+    }
     free(child->desc);
     free(child);
 }
 
+/*!
+ * \internal
+ * \brief Send SIGKILL to a child process (but not its process group)
+ *
+ * \param[in] child  Child process to kill
+ *
+ * \return 0 on success, -1 (with errno set) otherwise
+ */
+static int
+child_kill_pid(mainloop_child_t *child)
+{
+#if HAVE_DECL_SYS_PIDFD_SEND_SIGNAL
+    /* A pidfd always refers to the process it was opened for, so this can't
+     * hit an unrelated process that has reused the PID
+     */
+    if (child->pidfd >= 0) {
+        return (int) syscall(SYS_pidfd_send_signal, child->pidfd, SIGKILL,
+                             NULL, 0);
+    }
+#endif
+    return kill(child->pid, SIGKILL);
+}
+
 /* terrible function name */
 static int
 child_kill_helper(mainloop_child_t *child)
@@ -997,8 +1035,11 @@ child_kill_helper(mainloop_child_t *child)
     int rc;
     if (child->flags & mainloop_leave_pid_group) {
         crm_debug("Kill pid %d only. leave group intact.", child->pid);
-        rc = kill(child->pid, SIGKILL);
+        rc = child_kill_pid(child);
     } else {
+        /* There is no pidfd equivalent for a process group, but the group
+         * leader is our unreaped child, so its ID can't have been reused
+         */
         crm_debug("Kill pid %d's group", child->pid);
         rc = kill(-child->pid, SIGKILL);
     }
@@ -1105,6 +1146,9 @@ child_death_dispatch(int signal)
         mainloop_child_t *child = iter->data;
 
         iter = iter->next;
+        if (child->pidfd_source != NULL) {
+            continue; // Reaped when its pidfd becomes readable
+        }
         if (child_waitpid(child, WNOHANG)) {
             crm_trace("Removing completed process %d from child list",
                       child->pid);
@@ -1115,6 +1159,108 @@ child_death_dispatch(int signal)
     }
 }
 
+#if HAVE_DECL_SYS_PIDFD_OPEN
+static int
+child_pidfd_dispatch(gpointer userdata)
+{
+    mainloop_child_t *child = userdata;
+
+    if (!child_waitpid(child, WNOHANG)) {
+        return 0;
+    }
+    crm_trace("Removing completed process %d from child list", child->pid);
+    child_list = g_list_remove(child_list, child);
+
+    // Returning -1 removes the source, so child_free() mustn't
+    child->pidfd_source = NULL;
+    child_free(child);
+    return -1;
+}
+
+static struct mainloop_fd_callbacks child_pidfd_callbacks = {
+    .dispatch = child_pidfd_dispatch,
+    .destroy = NULL,
+};
+#endif
+
+/*!
+ * \internal
+ * \brief Track a child process via a process file descriptor, if possible
+ *
+ * With a pidfd, only the exiting child needs to be checked when it exits,
+ * rather than every tracked child whenever any SIGCHLD arrives.
+ *
+ * \param[in] child  Child process to track
+ *
+ * \return true if the child is tracked via a pidfd, false if SIGCHLD is needed
+ */
+static bool
+child_watch_pidfd(mainloop_child_t *child)
+{
+#if HAVE_DECL_SYS_PIDFD_OPEN
+    if (child->pid <= 0) {
+        return false; // Process groups can be tracked only via SIGCHLD
+    }
+
+    child->pidfd = (int) syscall(SYS_pidfd_open, child->pid, 0);
+    if (child->pidfd < 0) {
+        // Most likely, the kernel is older than 5.3
+        crm_trace("Tracking child process %d via SIGCHLD: %s",
+                  child->pid, pcmk_strerror(errno));
+        child->pidfd = -1;
+        return false;
+    }
+
+    child->pidfd_source = mainloop_add_fd("child-pidfd", G_PRIORITY_HIGH,
+                                          child->pidfd, child,
+                                          &child_pidfd_callbacks);
+    if (child->pidfd_source == NULL) {
+        close(child->pidfd);
+        child->pidfd = -1;
+        return false;
+    }
+    crm_trace("Tracking child process %d via pidfd %d",
+              child->pid, child->pidfd);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*!
+ * \internal
+ * \brief Make sure exited children are left for us to reap
+ *
+ * If SIGCHLD is ignored (which may have been inherited from our parent), the
+ * kernel reaps exited children itself, and waitpid() on them fails. Installing
+ * the SIGCHLD handler takes care of that, but it is not installed when children
+ * are tracked via pidfd, so restore the default disposition instead.
+ */
+static void
+child_sigchld_default(void)
+{
+    static bool checked = false;
+    struct sigaction sa;
+
+    if (checked) {
+        return;
+    }
+    checked = true;
+
+    if ((sigaction(SIGCHLD, NULL, &sa) == 0)
+        && ((sa.sa_handler == SIG_IGN) || (sa.sa_flags & SA_NOCLDWAIT))) {
+        crm_debug("Restoring default handling of SIGCHLD so that children "
+                  "can be reaped");
+        memset(&sa, 0, sizeof(struct sigaction));
+        sa.sa_handler = SIG_DFL;
+        sigemptyset(&sa.sa_mask);
+        if (sigaction(SIGCHLD, &sa, NULL) < 0) {
+            crm_perror(LOG_WARNING,
+                       "Could not restore default handling of SIGCHLD");
+        }
+    }
+}
+
 static gboolean
 child_signal_init(gpointer p)
 {
@@ -1151,9 +1297,9 @@ mainloop_child_kill(pid_t pid)
     rc = child_kill_helper(match);
     if(rc == -ESRCH) {
         /* It's gone, but hasn't shown up in waitpid() yet. Wait until we get
-         * SIGCHLD and let handler clean it up as normal (so we get the correct
-         * return code/status). The blocking alternative would be to call
-         * child_waitpid(match, 0).
+         * SIGCHLD (or its pidfd becomes readable) and let the handler clean it
+         * up as normal (so we get the correct return code/status). The
+         * blocking alternative would be to call child_waitpid(match, 0).
          */
         crm_trace("Waiting for signal that child process %d completed",
                   match->pid);
@@ -1188,7 +1334,7 @@ mainloop_child_add_with_flags(pid_t pid, int timeout, const char *desc, void *pr
                    void (*callback) (mainloop_child_t * p, pid_t pid, int core, int signo, int exitcode))
 {
     static bool need_init = TRUE;
-    mainloop_child_t *child = g_new(mainloop_child_t, 1);
+    mainloop_child_t *child = g_new0(mainloop_child_t, 1);
 
     child->pid = pid;
     child->timerid = 0;
@@ -1196,6 +1342,7 @@ mainloop_child_add_with_flags(pid_t pid, int timeout, const char *desc, void *pr
     child->privatedata = privatedata;
     child->callback = callback;
     child->flags = flags;
+    child->pidfd = -1;
 
     if(desc) {
         child->desc = strdup(desc);
@@ -1207,6 +1354,11 @@ mainloop_child_add_with_flags(pid_t pid, int timeout, const char *desc, void *pr
 
     child_list = g_list_append(child_list, child);
 
+    if (child_watch_pidfd(child)) {
+        child_sigchld_default();
+        return;
+    }
+
     if(need_init) {
         need_init = FALSE;
         /* SIGCHLD processing has to be invoked from mainloop.
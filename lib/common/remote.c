@@ -32,6 +32,7 @@
 #include <crm/common/xml.h>
 #include <crm/common/mainloop.h>
 #include <crm/common/remote_internal.h>
+#include <crm/common/xml_internal.h>  // pcmk__xml_serialize()
 
 #ifdef HAVE_GNUTLS_GNUTLS_H
 #  undef KEYFILE
@@ -489,27 +490,21 @@ crm_remote_sendv(pcmk__remote_t *remote, struct iovec * iov, int iovs)
     return rc;
 }
 
-int
-crm_remote_send(pcmk__remote_t *remote, xmlNode *msg)
+static int
+send_xml_text(pcmk__remote_t *remote, const char *xml_text, size_t length)
 {
     int rc = pcmk_ok;
     static uint64_t id = 0;
-    char *xml_text = dump_xml_unformatted(msg);
 
     struct iovec iov[2];
     struct crm_remote_header_v0 *header;
 
-    if (xml_text == NULL) {
-        crm_err("Could not send remote message: no message provided");
-        return -EINVAL;
-    }
-
     header = calloc(1, sizeof(struct crm_remote_header_v0));
     iov[0].iov_base = header;
     iov[0].iov_len = sizeof(struct crm_remote_header_v0);
 
-    iov[1].iov_base = xml_text;
-    iov[1].iov_len = 1 + strlen(xml_text);
+    iov[1].iov_base = (void *) xml_text;
+    iov[1].iov_len = 1 + length;
 
     id++;
     header->id = id;
@@ -520,7 +515,7 @@ crm_remote_send(pcmk__remote_t *remote, xmlNode *msg)
     header->size_total = iov[0].iov_len + iov[1].iov_len;
 
     crm_trace("Sending len[0]=%d, start=%x",
-              (int)iov[0].iov_len, *(int*)(void*)xml_text);
+              (int)iov[0].iov_len, *(const int*)(const void*)xml_text);
     rc = crm_remote_sendv(remote, iov, 2);
     if (rc < 0) {
         crm_err("Could not send remote message: %s " CRM_XS " rc=%d",
@@ -528,10 +523,48 @@ crm_remote_send(pcmk__remote_t *remote, xmlNode *msg)
     }
 
     free(iov[0].iov_base);
-    free(iov[1].iov_base);
     return rc;
 }
 
+/*!
+ * \internal
+ * \brief Send an already serialized XML message to a remote connection
+ *
+ * \param[in] remote    Remote connection to send message to
+ * \param[in] xml_text  Serialized XML to send
+ *
+ * \return Legacy Pacemaker return code
+ * \note This allows a message serialized once to be sent to many remote
+ *       connections.
+ */
+int
+pcmk__remote_send_text(pcmk__remote_t *remote, const char *xml_text)
+{
+    if (xml_text == NULL) {
+        crm_err("Could not send remote message: no message provided");
+        return -EINVAL;
+    }
+    return send_xml_text(remote, xml_text, strlen(xml_text));
+}
+
+int
+crm_remote_send(pcmk__remote_t *remote, xmlNode *msg)
+{
+    int rc = pcmk_ok;
+
+    /* The text is consumed before we return, so serialize into the same
+     * buffer every time rather than allocating a new one per message
+     */
+    static pcmk__xml_buf_t buffer = { NULL, 0, 0 };
+
+    if (pcmk__xml_serialize(msg, &buffer) == NULL) {
+        crm_err("Could not send remote message: no message provided");
+        return -EINVAL;
+    }
+    rc = send_xml_text(remote, buffer.str, buffer.len);
+    pcmk__xml_buf_done(&buffer);
+    return rc;
+}
 
 /*!
  * \internal
@@ -18,6 +18,9 @@
 #include <stdlib.h>
 #include <limits.h>
 #include <bzlib.h>
+#if PCMK__WITH_ZSTD
+#include <zstd.h>
+#endif
 #include <sys/types.h>
 
 char *
@@ -427,19 +430,149 @@ add_list_element(char *list, const char *value)
     return list;
 }
 
+/*!
+ * \internal
+ * \brief Get a readable name for a compression codec
+ *
+ * \param[in] codec  Codec to name
+ *
+ * \return Name of \p codec
+ */
+const char *
+pcmk__codec_text(enum pcmk__codec codec)
+{
+    switch (codec) {
+        case pcmk__codec_none:
+            return "no compression";
+        case pcmk__codec_bzip2:
+            return "bzip2";
+        case pcmk__codec_zstd:
+            return "zstd";
+    }
+    return "unknown codec";
+}
+
+/*!
+ * \internal
+ * \brief Check whether this build can use a compression codec
+ *
+ * \param[in] codec  Codec to check
+ *
+ * \return true if \p codec is supported, otherwise false
+ */
 bool
-crm_compress_string(const char *data, int length, int max, char **result, unsigned int *result_len)
+pcmk__codec_supported(enum pcmk__codec codec)
+{
+    switch (codec) {
+        case pcmk__codec_bzip2:
+            return true;
+        case pcmk__codec_zstd:
+#if PCMK__WITH_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        default:
+            return false;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Get the extension to use for names of compressed files
+ *
+ * Files are compressed with bzip2 unless the administrator has opted in to zstd
+ * via PCMK_file_compression, since older versions and tools such as bzcat can
+ * only read bzip2. The codec used is chosen by the extension when the file is
+ * written (see write_xml_file()), so the name always matches the contents.
+ *
+ * \return File name extension (without the dot) for compressed files
+ */
+const char *
+pcmk__compressed_file_ext(void)
+{
+    static enum pcmk__codec codec = pcmk__codec_none;
+
+    if (codec == pcmk__codec_none) {
+        const char *value = pcmk__env_option("file_compression");
+
+        codec = pcmk__codec_bzip2;
+        if (safe_str_eq(value, "zstd")) {
+            if (pcmk__codec_supported(pcmk__codec_zstd)) {
+                codec = pcmk__codec_zstd;
+            } else {
+                crm_warn("Using bzip2 for compressed files because this "
+                         "build does not support zstd");
+            }
+        } else if ((value != NULL) && safe_str_neq(value, "bzip2")) {
+            crm_warn("Ignoring invalid value '%s' for PCMK_file_compression",
+                     value);
+        }
+        crm_debug("Compressing files with %s", pcmk__codec_text(codec));
+    }
+    return (codec == pcmk__codec_zstd)? PCMK__ZSTD_EXT : PCMK__BZIP2_EXT;
+}
+
+/*!
+ * \internal
+ * \brief Detect the codec of compressed data from its magic number
+ *
+ * \param[in] data    Start of data to check
+ * \param[in] length  Number of bytes available at \p data
+ *
+ * \return Codec that \p data was compressed with (or pcmk__codec_none)
+ */
+enum pcmk__codec
+pcmk__codec_detect(const char *data, size_t length)
+{
+    static const unsigned char zstd_magic[] = { 0x28, 0xB5, 0x2F, 0xFD };
+
+    if ((data == NULL) || (length < 4)) {
+        return pcmk__codec_none;
+    }
+    if (strncmp(data, "BZh", 3) == 0) {
+        return pcmk__codec_bzip2;
+    }
+    if (memcmp(data, zstd_magic, sizeof(zstd_magic)) == 0) {
+        return pcmk__codec_zstd;
+    }
+    return pcmk__codec_none;
+}
+
+/*!
+ * \internal
+ * \brief Compress data with a given codec
+ *
+ * \param[in]  codec       Codec to use
+ * \param[in]  data        Data to compress
+ * \param[in]  length      Number of bytes of \p data to compress
+ * \param[in]  max         Maximum size of compressed result (or 0 for no limit)
+ * \param[out] result      Where to store newly allocated compressed data
+ * \param[out] result_len  Where to store size of compressed data
+ *
+ * \return true on success, otherwise false
+ */
+bool
+pcmk__compress(enum pcmk__codec codec, const char *data, unsigned int length,
+               unsigned int max, char **result, unsigned int *result_len)
 {
-    int rc;
     char *compressed = NULL;
-    char *uncompressed = strdup(data);
 #ifdef CLOCK_MONOTONIC
     struct timespec after_t;
     struct timespec before_t;
 #endif
 
-    if(max == 0) {
-        max = (length * 1.1) + 600; /* recommended size */
+    if (max == 0) {
+        switch (codec) {
+#if PCMK__WITH_ZSTD
+            case pcmk__codec_zstd:
+                max = ZSTD_compressBound(length);
+                break;
+#endif
+            default:
+                max = (length * 1.1) + 600; /* recommended size */
+                break;
+        }
     }
 
 #ifdef CLOCK_MONOTONIC
@@ -449,35 +582,130 @@ crm_compress_string(const char *data, int length, int max, char **result, unsign
     compressed = calloc(max, sizeof(char));
     CRM_ASSERT(compressed);
 
-    *result_len = max;
-    rc = BZ2_bzBuffToBuffCompress(compressed, result_len, uncompressed, length, CRM_BZ2_BLOCKS, 0,
-                                  CRM_BZ2_WORK);
-
-    free(uncompressed);
+    switch (codec) {
+        case pcmk__codec_bzip2:
+            {
+                int rc;
+
+                *result_len = max;
+                rc = BZ2_bzBuffToBuffCompress(compressed, result_len,
+                                              (char *) data, length,
+                                              CRM_BZ2_BLOCKS, 0, CRM_BZ2_WORK);
+                if (rc != BZ_OK) {
+                    crm_err("Compression of %d bytes failed: %s "
+                            CRM_XS " bzerror=%d",
+                            length, bz2_strerror(rc), rc);
+                    free(compressed);
+                    return FALSE;
+                }
+            }
+            break;
+
+#if PCMK__WITH_ZSTD
+        case pcmk__codec_zstd:
+            {
+                // Level 1 favors speed, which is the point of using zstd
+                size_t rc = ZSTD_compress(compressed, max, data, length, 1);
+
+                if (ZSTD_isError(rc)) {
+                    crm_err("Compression of %d bytes failed: %s",
+                            length, ZSTD_getErrorName(rc));
+                    free(compressed);
+                    return FALSE;
+                }
+                *result_len = (unsigned int) rc;
+            }
+            break;
+#endif
 
-    if (rc != BZ_OK) {
-        crm_err("Compression of %d bytes failed: %s " CRM_XS " bzerror=%d",
-                length, bz2_strerror(rc), rc);
-        free(compressed);
-        return FALSE;
+        default:
+            crm_err("Compression of %d bytes failed: %s not supported",
+                    length, pcmk__codec_text(codec));
+            free(compressed);
+            return FALSE;
     }
 
 #ifdef CLOCK_MONOTONIC
     clock_gettime(CLOCK_MONOTONIC, &after_t);
 
-    crm_trace("Compressed %d bytes into %d (ratio %d:1) in %.0fms",
-             length, *result_len, length / (*result_len),
+    crm_trace("Compressed %d bytes into %d with %s (ratio %d:1) in %.0fms",
+             length, *result_len, pcmk__codec_text(codec),
+             length / (*result_len),
              (after_t.tv_sec - before_t.tv_sec) * 1000 +
              (after_t.tv_nsec - before_t.tv_nsec) / 1e6);
 #else
-    crm_trace("Compressed %d bytes into %d (ratio %d:1)",
-             length, *result_len, length / (*result_len));
+    crm_trace("Compressed %d bytes into %d with %s (ratio %d:1)",
+             length, *result_len, pcmk__codec_text(codec),
+             length / (*result_len));
 #endif
 
     *result = compressed;
     return TRUE;
 }
 
+/*!
+ * \internal
+ * \brief Decompress data compressed with a given codec
+ *
+ * \param[in]     codec       Codec that data was compressed with
+ * \param[in]     data        Compressed data
+ * \param[in]     length      Number of bytes of compressed data
+ * \param[out]    result      Where to store decompressed data
+ * \param[in,out] result_len  Size of \p result on input, size of
+ *                            decompressed data on output
+ *
+ * \return Standard Pacemaker return code
+ */
+int
+pcmk__decompress(enum pcmk__codec codec, const char *data, unsigned int length,
+                 char *result, unsigned int *result_len)
+{
+    crm_trace("Decompressing %u bytes of %s data into at most %u bytes",
+              length, pcmk__codec_text(codec), *result_len);
+
+    switch (codec) {
+        case pcmk__codec_bzip2:
+            {
+                int rc = BZ2_bzBuffToBuffDecompress(result, result_len,
+                                                    (char *) data, length,
+                                                    1, 0);
+
+                if (rc != BZ_OK) {
+                    crm_err("Decompression failed: %s " CRM_XS " bzerror=%d",
+                            bz2_strerror(rc), rc);
+                    return EILSEQ;
+                }
+            }
+            return pcmk_rc_ok;
+
+#if PCMK__WITH_ZSTD
+        case pcmk__codec_zstd:
+            {
+                size_t rc = ZSTD_decompress(result, *result_len, data, length);
+
+                if (ZSTD_isError(rc)) {
+                    crm_err("Decompression failed: %s", ZSTD_getErrorName(rc));
+                    return EILSEQ;
+                }
+                *result_len = (unsigned int) rc;
+            }
+            return pcmk_rc_ok;
+#endif
+
+        default:
+            crm_err("Decompression failed: %s not supported",
+                    pcmk__codec_text(codec));
+            return EPROTONOSUPPORT;
+    }
+}
+
+bool
+crm_compress_string(const char *data, int length, int max, char **result, unsigned int *result_len)
+{
+    return pcmk__compress(pcmk__codec_bzip2, data, length, max, result,
+                          result_len);
+}
+
 /*!
  * \brief Compare two strings alphabetically (case-insensitive)
  *
@@ -18,6 +18,10 @@
 #include <stdarg.h>
 #include <bzlib.h>
 
+#if PCMK__WITH_ZSTD
+#include <zstd.h>
+#endif
+
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 #include <libxml/xmlIO.h>  /* xmlAllocOutputBuffer */
@@ -580,6 +584,89 @@ is_config_change(xmlNode *xml)
     return FALSE;
 }
 
+/*!
+ * \internal
+ * \brief Check whether a CIB's tracked changes are confined to its status
+ *
+ * The schema allows any content beneath the status section, so a change set
+ * that touches nothing else cannot make a valid CIB invalid. This lets callers
+ * skip full schema validation for the frequent status-only updates.
+ *
+ * \param[in] xml  CIB root element, with change tracking enabled
+ *
+ * \return true if all changes since tracking began are within an existing
+ *         status section (or there are no changes), otherwise false
+ * \note This must be called before the changes are accepted.
+ */
+bool
+pcmk__xml_status_only_changes(xmlNode *xml)
+{
+    int lpc = 0;
+    GListPtr gIter = NULL;
+    xmlAttr *pIter = NULL;
+    xmlNode *child = NULL;
+    xml_private_t *p = NULL;
+
+    // CIB bookkeeping attributes that cannot affect validity
+    const char *ignored[] = {
+        XML_ATTR_NUMUPDATES,
+        XML_CIB_ATTR_WRITTEN,
+        XML_ATTR_UPDATE_ORIG,
+        XML_ATTR_UPDATE_CLIENT,
+        XML_ATTR_UPDATE_USER,
+        XML_ATTR_DC_UUID,
+    };
+
+    if ((xml == NULL) || (xml->doc == NULL) || (xml->doc->_private == NULL)
+        || (xml_tracking_changes(xml) == FALSE)) {
+        return false;
+    }
+    if (xml_document_dirty(xml) == FALSE) {
+        return true;
+    }
+
+    for (pIter = pcmk__first_xml_attr(xml); pIter != NULL; pIter = pIter->next) {
+        p = pIter->_private;
+        if (p && (p->flags & (xpf_dirty|xpf_deleted))) {
+            bool ignore = false;
+
+            for (lpc = 0; lpc < DIMOF(ignored); lpc++) {
+                if (strcmp((const char *) pIter->name, ignored[lpc]) == 0) {
+                    ignore = true;
+                    break;
+                }
+            }
+            if (!ignore) {
+                return false;
+            }
+        }
+    }
+
+    for (child = __xml_first_child(xml); child != NULL;
+         child = __xml_next(child)) {
+
+        p = child->_private;
+        if ((p == NULL) || is_not_set(p->flags, xpf_dirty)) {
+            continue;
+        }
+        if (strcmp((const char *) child->name, XML_CIB_TAG_STATUS)
+            || (p->flags & (xpf_created|xpf_moved))) {
+            return false;
+        }
+    }
+
+    p = xml->doc->_private;
+    for (gIter = p->deleted_objs; gIter; gIter = gIter->next) {
+        xml_deleted_obj_t *deleted_obj = gIter->data;
+
+        if (!crm_starts_with(deleted_obj->path,
+                             "/"XML_TAG_CIB"/"XML_CIB_TAG_STATUS"/")) {
+            return false;
+        }
+    }
+    return true;
+}
+
 static void
 xml_repair_v1_diff(xmlNode * last, xmlNode * next, xmlNode * local_diff, gboolean changed)
 {
@@ -1388,13 +1475,133 @@ __first_xml_child_match(xmlNode *parent, const char *name, const char *id, int p
     return NULL;
 }
 
+/*!
+ * \internal
+ * \brief Create a key for a child in a patch application index
+ *
+ * \param[in] name  Child's element name
+ * \param[in] id    Child's ID (or NULL to match first child with \p name)
+ *
+ * \return Newly allocated key
+ */
+static char *
+child_index_key(const char *name, const char *id)
+{
+    return id? crm_strdup_printf("%s[@id='%s']", name, id) : strdup(name);
+}
+
+/*!
+ * \internal
+ * \brief Find a child by name and ID, using a lazily built per-parent index
+ *
+ * \param[in,out] index   Table mapping parents to tables of their children
+ * \param[in]     parent  Node whose children should be searched
+ * \param[in]     name    Element name to search for
+ * \param[in]     id      ID to search for (or NULL to match any)
+ *
+ * \return First child of \p parent matching \p name and \p id if found,
+ *         otherwise NULL
+ * \note Applying a patchset looks up many siblings under the same parent
+ *       (for example, resource history under one node), so index each parent's
+ *       children on first use rather than rescanning them for every change.
+ *       A miss falls back to a scan, so the index only needs to guarantee that
+ *       any entry it has is still a matching child of \p parent.
+ */
+static xmlNode *
+indexed_child_match(GHashTable *index, xmlNode *parent, const char *name,
+                    const char *id)
+{
+    GHashTable *children = g_hash_table_lookup(index, parent);
+    xmlNode *match = NULL;
+    char *key = NULL;
+
+    if (children == NULL) {
+        xmlNode *cIter = NULL;
+
+        children = g_hash_table_new_full(crm_str_hash, g_str_equal, free, NULL);
+        for (cIter = __xml_first_child(parent); cIter != NULL;
+             cIter = __xml_next(cIter)) {
+
+            const char *cid = ID(cIter);
+
+            key = child_index_key((const char *) cIter->name, NULL);
+            if (g_hash_table_lookup(children, key) != NULL) {
+                free(key);
+            } else {
+                g_hash_table_insert(children, key, cIter);
+            }
+
+            if (cid != NULL) {
+                key = child_index_key((const char *) cIter->name, cid);
+                if (g_hash_table_lookup(children, key) != NULL) {
+                    free(key);
+                } else {
+                    g_hash_table_insert(children, key, cIter);
+                }
+            }
+        }
+        g_hash_table_insert(index, parent, children);
+    }
+
+    key = child_index_key(name, id);
+    match = g_hash_table_lookup(children, key);
+    free(key);
+
+    if (match == NULL) {
+        match = __first_xml_child_match(parent, name, id, -1);
+    }
+    return match;
+}
+
+/*!
+ * \internal
+ * \brief Remove a child's entries from a patch application index
+ *
+ * \param[in,out] index  Table mapping parents to tables of their children
+ * \param[in]     child  Child to remove
+ * \param[in]     id     ID that \p child was indexed under (or NULL)
+ */
+static void
+unindex_child(GHashTable *index, xmlNode *child, const char *id)
+{
+    GHashTable *children = NULL;
+    char *key = NULL;
+
+    if (index == NULL) {
+        return;
+    }
+
+    // Anything indexed beneath the child is unreachable after this
+    g_hash_table_remove(index, child);
+
+    children = g_hash_table_lookup(index, child->parent);
+    if (children == NULL) {
+        return;
+    }
+
+    key = child_index_key((const char *) child->name, NULL);
+    if (g_hash_table_lookup(children, key) == child) {
+        g_hash_table_remove(children, key);
+    }
+    free(key);
+
+    if (id != NULL) {
+        key = child_index_key((const char *) child->name, id);
+        if (g_hash_table_lookup(children, key) == child) {
+            g_hash_table_remove(children, key);
+        }
+        free(key);
+    }
+}
+
 /*!
  * \internal
  * \brief Simplified, more efficient alternative to get_xpath_object()
  *
- * \param[in] top              Root of XML to search
- * \param[in] key              Search xpath
- * \param[in] target_position  If deleting, where to delete
+ * \param[in]     top              Root of XML to search
+ * \param[in]     key              Search xpath
+ * \param[in]     target_position  If deleting, where to delete
+ * \param[in,out] index            If not NULL, child index to use and update
  *
  * \return XML child matching xpath if found, NULL otherwise
  *
@@ -1402,7 +1609,8 @@ __first_xml_child_match(xmlNode *parent, const char *name, const char *id, int p
  *       i.e. the only allowed search predicate is [@id='XXX'].
  */
 static xmlNode *
-__xml_find_path(xmlNode *top, const char *key, int target_position)
+__xml_find_path(xmlNode *top, const char *key, int target_position,
+                GHashTable *index)
 {
     xmlNode *target = (xmlNode*) top->doc;
     const char *current = key;
@@ -1450,10 +1658,18 @@ __xml_find_path(xmlNode *top, const char *key, int target_position)
 
             switch (f) {
                 case 1:
-                    target = __first_xml_child_match(target, tag, NULL, current_position);
+                    if ((index != NULL) && (current_position < 0)) {
+                        target = indexed_child_match(index, target, tag, NULL);
+                    } else {
+                        target = __first_xml_child_match(target, tag, NULL, current_position);
+                    }
                     break;
                 case 2:
-                    target = __first_xml_child_match(target, tag, id, current_position);
+                    if ((index != NULL) && (current_position < 0)) {
+                        target = indexed_child_match(index, target, tag, id);
+                    } else {
+                        target = __first_xml_child_match(target, tag, id, current_position);
+                    }
                     break;
                 default:
                     // This should not be possible
@@ -1514,6 +1730,8 @@ xml_apply_patchset_v2(xmlNode *xml, xmlNode *patchset)
     xmlNode *change = NULL;
     GListPtr change_objs = NULL;
     GListPtr gIter = NULL;
+    GHashTable *index = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                              NULL, (GDestroyNotify) g_hash_table_destroy);
 
     for (change = __xml_first_child(patchset); change != NULL; change = __xml_next(change)) {
         xmlNode *match = NULL;
@@ -1531,7 +1749,7 @@ xml_apply_patchset_v2(xmlNode *xml, xmlNode *patchset)
         if(strcmp(op, "delete") == 0) {
             crm_element_value_int(change, XML_DIFF_POSITION, &position);
         }
-        match = __xml_find_path(xml, xpath, position);
+        match = __xml_find_path(xml, xpath, position, index);
         crm_trace("Performing %s on %s with %p", op, xpath, match);
 
         if(match == NULL && strcmp(op, "delete") == 0) {
@@ -1552,7 +1770,7 @@ xml_apply_patchset_v2(xmlNode *xml, xmlNode *patchset)
             change_obj->change = change;
             change_obj->match = match;
 
-            change_objs = g_list_append(change_objs, change_obj);
+            change_objs = g_list_prepend(change_objs, change_obj);
 
             if (strcmp(op, "move") == 0) {
                 // Temporarily put the "move" object after the last sibling
@@ -1562,16 +1780,21 @@ xml_apply_patchset_v2(xmlNode *xml, xmlNode *patchset)
             }
 
         } else if(strcmp(op, "delete") == 0) {
+            unindex_child(index, match, ID(match));
             free_xml(match);
 
         } else if(strcmp(op, "modify") == 0) {
             xmlAttr *pIter = pcmk__first_xml_attr(match);
             xmlNode *attrs = __xml_first_child(first_named_child(change, XML_DIFF_RESULT));
+            char *old_id = NULL;
 
             if(attrs == NULL) {
                 rc = -ENOMSG;
                 continue;
             }
+            if (ID(match) != NULL) {
+                old_id = strdup(ID(match));
+            }
             while(pIter != NULL) {
                 const char *name = (const char *)pIter->name;
 
@@ -1586,13 +1809,23 @@ xml_apply_patchset_v2(xmlNode *xml, xmlNode *patchset)
                 crm_xml_add(match, name, value);
             }
 
+            // An ID change would leave a stale index entry
+            if (safe_str_neq(old_id, ID(match))) {
+                unindex_child(index, match, old_id);
+            }
+            free(old_id);
+
         } else {
             crm_err("Unknown operation: %s", op);
             rc = -pcmk_err_diff_failed;
         }
     }
 
+    // Nothing more needs to be looked up
+    g_hash_table_destroy(index);
+
     // Changes should be generated in the right order. Double checking.
+    change_objs = g_list_reverse(change_objs);
     change_objs = g_list_sort(change_objs, sort_change_obj_by_position);
 
     for (gIter = change_objs; gIter; gIter = gIter->next) {
@@ -2322,6 +2555,112 @@ decompress_file(const char *filename)
     return buffer;
 }
 
+static char *
+decompress_zstd_file(const char *filename)
+{
+    char *buffer = NULL;
+
+#if PCMK__WITH_ZSTD
+    size_t rc = 1;
+    size_t length = 0;
+    size_t in_size = ZSTD_DStreamInSize();
+    size_t out_size = ZSTD_DStreamOutSize();
+    char *in_buf = NULL;
+    ZSTD_outBuffer out = { NULL, 0, 0 };
+    ZSTD_DStream *stream = NULL;
+    FILE *input = fopen(filename, "r");
+
+    if (input == NULL) {
+        crm_perror(LOG_ERR, "Could not open %s for reading", filename);
+        return NULL;
+    }
+
+    stream = ZSTD_createDStream();
+    in_buf = malloc(in_size);
+    if ((stream == NULL) || (in_buf == NULL)) {
+        crm_err("Could not prepare to read compressed %s", filename);
+        goto done;
+    }
+    ZSTD_initDStream(stream);
+
+    while (rc != 0) {
+        ZSTD_inBuffer in = { in_buf, 0, 0 };
+
+        in.size = fread(in_buf, 1, in_size, input);
+        if ((in.size == 0) && ferror(input)) {
+            break;
+        }
+
+        /* Keep going until all input is consumed and the decoder has room to
+         * spare, since a full output buffer may mean it has more to flush
+         * (even after the last of the input has been read)
+         */
+        do {
+            buffer = realloc_safe(buffer, length + out_size + 1);
+            out.dst = buffer + length;
+            out.size = out_size;
+            out.pos = 0;
+            rc = ZSTD_decompressStream(stream, &out, &in);
+            if (ZSTD_isError(rc)) {
+                crm_err("Could not read compressed %s: %s",
+                        filename, ZSTD_getErrorName(rc));
+                free(buffer);
+                buffer = NULL;
+                goto done;
+            }
+            length += out.pos;
+        } while ((in.pos < in.size) || (out.pos == out.size));
+
+        if (in.size == 0) {
+            break; // EOF, so rc != 0 means the data was truncated
+        }
+    }
+
+    if (rc != 0) {
+        crm_err("Could not read compressed %s: %s", filename,
+                (ferror(input)? strerror(errno) : "Truncated data"));
+        free(buffer);
+        buffer = NULL;
+
+    } else if (buffer != NULL) {
+        buffer[length] = '\0';
+    }
+
+done:
+    free(in_buf);
+    ZSTD_freeDStream(stream);
+    fclose(input);
+#else
+    crm_err("Could not read compressed %s: not built with zstd support",
+            filename);
+#endif
+    return buffer;
+}
+
+/*!
+ * \internal
+ * \brief Determine how a file is compressed by looking at its first bytes
+ *
+ * \param[in] filename  Name of file to check
+ *
+ * \return Codec used to compress \p filename (or pcmk__codec_none if the
+ *         file is not compressed or cannot be read)
+ */
+static enum pcmk__codec
+file_codec(const char *filename)
+{
+    char magic[4];
+    size_t length = 0;
+    FILE *input = fopen(filename, "r");
+
+    if (input == NULL) {
+        return pcmk__codec_none; // Let the XML parser report the error
+    }
+    length = fread(magic, 1, sizeof(magic), input);
+    fclose(input);
+    return pcmk__codec_detect(magic, length);
+}
+
 void
 strip_text_nodes(xmlNode * xml)
 {
@@ -2355,7 +2694,7 @@ filename2xml(const char *filename)
 {
     xmlNode *xml = NULL;
     xmlDocPtr output = NULL;
-    gboolean uncompressed = TRUE;
+    enum pcmk__codec codec = pcmk__codec_none;
     xmlParserCtxtPtr ctxt = NULL;
     xmlErrorPtr last_error = NULL;
 
@@ -2367,7 +2706,10 @@ filename2xml(const char *filename)
     xmlSetGenericErrorFunc(ctxt, crm_xml_err);
 
     if (filename) {
-        uncompressed = !crm_ends_with_ext(filename, ".bz2");
+        /* Go by content rather than extension, so that a file compressed with
+         * any supported codec can be read regardless of its name
+         */
+        codec = file_codec(filename);
     }
 
     if (filename == NULL) {
@@ -2375,11 +2717,12 @@ filename2xml(const char *filename)
         output = xmlCtxtReadFd(ctxt, STDIN_FILENO, "unknown.xml", NULL,
                                PCMK__XML_PARSE_OPTS);
 
-    } else if (uncompressed) {
+    } else if (codec == pcmk__codec_none) {
         output = xmlCtxtReadFile(ctxt, filename, NULL, PCMK__XML_PARSE_OPTS);
 
     } else {
-        char *input = decompress_file(filename);
+        char *input = (codec == pcmk__codec_zstd)?
+                      decompress_zstd_file(filename) : decompress_file(filename);
 
         output = xmlCtxtReadDoc(ctxt, (pcmkXmlStr) input, NULL, NULL,
                                 PCMK__XML_PARSE_OPTS);
@@ -2479,9 +2822,11 @@ crm_xml_set_id(xmlNode *xml, const char *format, ...)
  * \brief Write XML to a file stream
  *
  * \param[in] xml_node  XML to write
- * \param[in] filename  Name of file being written (for logging only)
+ * \param[in] filename  Name of file being written (for logging, and to choose
+ *                      compression codec)
  * \param[in] stream    Open file stream corresponding to filename
- * \param[in] compress  Whether to compress XML before writing
+ * \param[in] compress  Whether to compress XML before writing (with zstd if
+ *                      \p filename ends in ".zst", otherwise with bzip2)
  *
  * \return Number of bytes written on success, -errno otherwise
  */
@@ -2500,7 +2845,33 @@ write_xml_stream(xmlNode * xml_node, const char *filename, FILE * stream, gboole
               res = -pcmk_err_generic;
               goto bail);
 
-    if (compress) {
+    // The codec follows the file name, so that the two always agree
+    if (compress && crm_ends_with_ext(filename, "." PCMK__ZSTD_EXT)) {
+        char *compressed = NULL;
+        unsigned int in = strlen(buffer);
+
+        if (!pcmk__codec_supported(pcmk__codec_zstd)) {
+            crm_warn("Not compressing %s: not built with zstd support",
+                     filename);
+
+        } else if (pcmk__compress(pcmk__codec_zstd, buffer, in, 0,
+                                  &compressed, &out)) {
+            if (fwrite(compressed, 1, out, stream) != out) {
+                res = -errno;
+                crm_perror(LOG_ERR, "writing %s", filename);
+                free(compressed);
+                goto bail;
+            }
+            res = (int) out;
+            crm_trace("Compressed XML for %s from %u bytes to %u",
+                      filename, in, out);
+        } else {
+            crm_warn("Not compressing %s: could not compress data", filename);
+            out = 0; // write without compression
+        }
+        free(compressed);
+
+    } else if (compress) {
 #if HAVE_BZLIB_H
         int rc = BZ_OK;
         unsigned int in = 0;
@@ -2572,9 +2943,11 @@ write_xml_stream(xmlNode * xml_node, const char *filename, FILE * stream, gboole
  * \brief Write XML to a file descriptor
  *
  * \param[in] xml_node  XML to write
- * \param[in] filename  Name of file being written (for logging only)
+ * \param[in] filename  Name of file being written (for logging, and to choose
+ *                      compression codec)
  * \param[in] fd        Open file descriptor corresponding to filename
- * \param[in] compress  Whether to compress XML before writing
+ * \param[in] compress  Whether to compress XML before writing (with zstd if
+ *                      \p filename ends in ".zst", otherwise with bzip2)
  *
  * \return Number of bytes written on success, -errno otherwise
  */
@@ -2596,7 +2969,8 @@ write_xml_fd(xmlNode * xml_node, const char *filename, int fd, gboolean compress
  *
  * \param[in] xml_node  XML to write
  * \param[in] filename  Name of file to write
- * \param[in] compress  Whether to compress XML before writing
+ * \param[in] compress  Whether to compress XML before writing (with zstd if
+ *                      \p filename ends in ".zst", otherwise with bzip2)
  *
  * \return Number of bytes written on success, -errno otherwise
  */
@@ -3316,11 +3690,274 @@ dump_xml_formatted(xmlNode * an_xml_node)
 char *
 dump_xml_unformatted(xmlNode * an_xml_node)
 {
-    char *buffer = NULL;
-    int offset = 0, max = 0;
+    pcmk__xml_buf_t buf = { NULL, 0, 0 };
 
-    crm_xml_dump(an_xml_node, 0, &buffer, &offset, &max, 0);
-    return buffer;
+    pcmk__xml_serialize(an_xml_node, &buf);
+    return pcmk__xml_buf_steal(&buf);
+}
+
+/* Reused buffers larger than this are released after use rather than kept
+ * around indefinitely (see pcmk__xml_buf_done())
+ */
+#define XML_BUF_KEEP_MAX (1024 * 1024)
+
+// Length of the most recently serialized XML, used to size new buffers
+static size_t xml_buf_hint = 0;
+
+/*!
+ * \internal
+ * \brief Make sure a serialization buffer has room for more output
+ *
+ * \param[in,out] buf    Buffer to check
+ * \param[in]     extra  Number of bytes about to be appended
+ */
+static inline void
+xml_buf_reserve(pcmk__xml_buf_t *buf, size_t extra)
+{
+    size_t needed = buf->len + extra + 1; // +1 for terminating NUL
+
+    if (needed > buf->size) {
+        buf->size = QB_MAX(QB_MAX(CHUNK_SIZE, needed), buf->size * 2);
+        buf->str = realloc_safe(buf->str, buf->size);
+    }
+}
+
+static inline void
+xml_buf_add(pcmk__xml_buf_t *buf, const char *text, size_t length)
+{
+    xml_buf_reserve(buf, length);
+    memcpy(buf->str + buf->len, text, length);
+    buf->len += length;
+}
+
+static inline void
+xml_buf_add_str(pcmk__xml_buf_t *buf, const char *text)
+{
+    if (text != NULL) {
+        xml_buf_add(buf, text, strlen(text));
+    }
+}
+
+/*!
+ * \internal
+ * \brief Append an escaped attribute value to a serialization buffer
+ *
+ * This produces the same result as crm_xml_escape(), without allocating an
+ * intermediate copy of the value.
+ *
+ * \param[in,out] buf    Buffer to append to
+ * \param[in]     value  Attribute value to escape
+ */
+static void
+xml_buf_add_escaped(pcmk__xml_buf_t *buf, const char *value)
+{
+    const char *start = value;
+    const char *c = NULL;
+
+    for (c = value; *c != '\0'; c++) {
+        const char *replace = NULL;
+        char octal[16];
+
+        switch (*c) {
+            case '<':
+                replace = "&lt;";
+                break;
+            case '>':
+                replace = "&gt;";
+                break;
+            case '"':
+                replace = "&quot;";
+                break;
+            case '\'':
+                replace = "&apos;";
+                break;
+            case '&':
+                replace = "&amp;";
+                break;
+            case '\t':
+                replace = "    ";
+                break;
+            case '\n':
+                replace = "\\n";
+                break;
+            case '\r':
+                replace = "\\r";
+                break;
+            default:
+                if ((*c < ' ') || (*c > '~')) {
+                    snprintf(octal, sizeof(octal), "\\%.3o", *c);
+                    replace = octal;
+                }
+                break;
+        }
+        if (replace != NULL) {
+            // Copy any run of unescaped characters in one go
+            xml_buf_add(buf, start, c - start);
+            xml_buf_add_str(buf, replace);
+            start = c + 1;
+        }
+    }
+    xml_buf_add(buf, start, c - start);
+}
+
+static void
+xml_buf_add_node(pcmk__xml_buf_t *buf, xmlNode *xml)
+{
+    switch (xml->type) {
+        case XML_ELEMENT_NODE:
+            {
+                const char *name = crm_element_name(xml);
+                xmlAttrPtr attr = NULL;
+                xmlNode *child = NULL;
+
+                CRM_ASSERT(name != NULL);
+                xml_buf_add(buf, "<", 1);
+                xml_buf_add_str(buf, name);
+
+                for (attr = pcmk__first_xml_attr(xml); attr != NULL;
+                     attr = attr->next) {
+                    xml_private_t *p = attr->_private;
+
+                    if ((attr->children == NULL)
+                        || (p && is_set(p->flags, xpf_deleted))) {
+                        continue;
+                    }
+                    xml_buf_add(buf, " ", 1);
+                    xml_buf_add_str(buf, (const char *) attr->name);
+                    xml_buf_add(buf, "=\"", 2);
+                    xml_buf_add_escaped(buf,
+                                        (const char *) attr->children->content);
+                    xml_buf_add(buf, "\"", 1);
+                }
+
+                if (xml->children == NULL) {
+                    xml_buf_add(buf, "/>", 2);
+                    break;
+                }
+                xml_buf_add(buf, ">", 1);
+                for (child = xml->children; child != NULL;
+                     child = child->next) {
+                    xml_buf_add_node(buf, child);
+                }
+                xml_buf_add(buf, "</", 2);
+                xml_buf_add_str(buf, name);
+                xml_buf_add(buf, ">", 1);
+            }
+            break;
+
+        case XML_TEXT_NODE:
+            // Unformatted output does not include text
+            break;
+
+        case XML_COMMENT_NODE:
+            xml_buf_add(buf, "<!--", 4);
+            xml_buf_add_str(buf, (const char *) xml->content);
+            xml_buf_add(buf, "-->", 3);
+            break;
+
+        case XML_CDATA_SECTION_NODE:
+            xml_buf_add(buf, "<![CDATA[", 9);
+            xml_buf_add_str(buf, (const char *) xml->content);
+            xml_buf_add(buf, "]]>", 3);
+            break;
+
+        default:
+            crm_warn("Unhandled type: %d", xml->type);
+            break;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Serialize XML (unformatted) into a reusable buffer
+ *
+ * This produces the same text as dump_xml_unformatted(), but appends directly
+ * into \p buf rather than formatting each piece separately, and tracks the
+ * length so callers do not need to scan the result again. An existing
+ * allocation in \p buf is reused, and a new one is sized based on the previous
+ * serialization, so that large messages are normally produced without any
+ * intermediate copies.
+ *
+ * \param[in]     xml  XML to serialize
+ * \param[in,out] buf  Buffer to serialize into (any previous content is
+ *                     discarded)
+ *
+ * \return Serialized XML (owned by \p buf), or NULL if \p xml is NULL
+ * \note The caller can take ownership of the result with
+ *       pcmk__xml_buf_steal(), or call pcmk__xml_buf_done() when finished.
+ */
+const char *
+pcmk__xml_serialize(xmlNode *xml, pcmk__xml_buf_t *buf)
+{
+    CRM_ASSERT(buf != NULL);
+
+    buf->len = 0;
+    if (xml == NULL) {
+        return NULL;
+    }
+    if (buf->str == NULL) {
+        buf->size = 0;
+        xml_buf_reserve(buf, xml_buf_hint + (xml_buf_hint / 8));
+    }
+
+    xml_buf_add_node(buf, xml);
+    xml_buf_reserve(buf, 0);
+    buf->str[buf->len] = '\0';
+
+    xml_buf_hint = buf->len;
+    return buf->str;
+}
+
+/*!
+ * \internal
+ * \brief Take ownership of the serialized XML in a buffer
+ *
+ * \param[in,out] buf  Buffer to take result from (this will be reset)
+ *
+ * \return Serialized XML (which the caller must free), trimmed to its length
+ * \note A new buffer is sized for the previous serialization, which may have
+ *       been much larger, so the result is trimmed rather than handed off with
+ *       the whole allocation.
+ */
+char *
+pcmk__xml_buf_steal(pcmk__xml_buf_t *buf)
+{
+    char *result = NULL;
+
+    CRM_ASSERT(buf != NULL);
+
+    result = buf->str;
+    if ((result != NULL) && (buf->size > (buf->len + 1))) {
+        result = realloc_safe(result, buf->len + 1);
+    }
+    buf->str = NULL;
+    buf->len = 0;
+    buf->size = 0;
+    return result;
+}
+
+/*!
+ * \internal
+ * \brief Finish using a reusable serialization buffer
+ *
+ * \param[in,out] buf  Buffer to finish with
+ *
+ * \note Unusually large allocations are freed so that one big message does not
+ *       pin memory for the life of the process; smaller ones are kept for
+ *       reuse by the next pcmk__xml_serialize() call.
+ */
+void
+pcmk__xml_buf_done(pcmk__xml_buf_t *buf)
+{
+    if (buf == NULL) {
+        return;
+    }
+    if (buf->size > XML_BUF_KEEP_MAX) {
+        free(buf->str);
+        buf->str = NULL;
+        buf->size = 0;
+    }
+    buf->len = 0;
 }
 
 gboolean
@@ -4459,6 +5096,7 @@ crm_xml_cleanup(void)
 {
     crm_info("Cleaning up memory from libxml2");
     crm_schema_cleanup();
+    pcmk__xpath_cleanup();
     xmlCleanupParser();
 }
 
@@ -8,8 +8,17 @@
  */
 
 #include <crm_internal.h>
+#include <ctype.h>
 #include <stdio.h>
 #include <string.h>
+#include <crm/common/xml.h>
+#include "crmcommon_private.h"
+
+// Maximum number of compiled XPath expressions to keep
+#define XPATH_CACHE_MAX 256
+
+// Compiled XPath expressions, by expression string
+static GHashTable *xpath_cache = NULL;
 
 /*
  * From xpath2.c
@@ -131,6 +140,58 @@ dedupXpathResults(xmlXPathObjectPtr xpathObj)
     }
 }
 
+/*!
+ * \internal
+ * \brief Get a compiled version of an XPath expression
+ *
+ * \param[in] path  XPath expression
+ *
+ * \return Compiled expression (owned by the cache) if valid, otherwise NULL
+ * \note Daemons evaluate the same handful of expressions for every message, so
+ *       compile each only once.
+ */
+static xmlXPathCompExprPtr
+compiled_xpath(const char *path)
+{
+    xmlXPathCompExprPtr comp = NULL;
+
+    if (xpath_cache == NULL) {
+        xpath_cache = g_hash_table_new_full(crm_str_hash, g_str_equal, free,
+                                            (GDestroyNotify) xmlXPathFreeCompExpr);
+    }
+
+    comp = g_hash_table_lookup(xpath_cache, path);
+    if (comp == NULL) {
+        comp = xmlXPathCompile((pcmkXmlStr) path);
+        if (comp == NULL) {
+            return NULL;
+        }
+
+        /* Expressions with embedded IDs make the set of possible expressions
+         * unbounded, so just start over if the cache gets too big.
+         */
+        if (g_hash_table_size(xpath_cache) >= XPATH_CACHE_MAX) {
+            crm_trace("Clearing XPath cache");
+            g_hash_table_remove_all(xpath_cache);
+        }
+        g_hash_table_insert(xpath_cache, strdup(path), comp);
+    }
+    return comp;
+}
+
+/*!
+ * \internal
+ * \brief Free all compiled XPath expressions
+ */
+void
+pcmk__xpath_cleanup(void)
+{
+    if (xpath_cache != NULL) {
+        g_hash_table_destroy(xpath_cache);
+        xpath_cache = NULL;
+    }
+}
+
 /* the caller needs to check if the result contains a xmlDocPtr or xmlNodePtr */
 xmlXPathObjectPtr
 xpath_search(xmlNode * xml_top, const char *path)
@@ -138,7 +199,7 @@ xpath_search(xmlNode * xml_top, const char *path)
     xmlDocPtr doc = NULL;
     xmlXPathObjectPtr xpathObj = NULL;
     xmlXPathContextPtr xpathCtx = NULL;
-    const xmlChar *xpathExpr = (pcmkXmlStr) path;
+    xmlXPathCompExprPtr comp = NULL;
 
     CRM_CHECK(path != NULL, return NULL);
     CRM_CHECK(xml_top != NULL, return NULL);
@@ -146,10 +207,15 @@ xpath_search(xmlNode * xml_top, const char *path)
 
     doc = getDocPtr(xml_top);
 
+    comp = compiled_xpath(path);
+    if (comp == NULL) {
+        return NULL;
+    }
+
     xpathCtx = xmlXPathNewContext(doc);
     CRM_ASSERT(xpathCtx != NULL);
 
-    xpathObj = xmlXPathEvalExpression(xpathExpr, xpathCtx);
+    xpathObj = xmlXPathCompiledEval(comp, xpathCtx);
     xmlXPathFreeContext(xpathCtx);
     return xpathObj;
 }
@@ -207,10 +273,85 @@ get_xpath_object_relative(const char *xpath, xmlNode * xml_obj, int error_level)
     return result;
 }
 
+/*!
+ * \internal
+ * \brief Check whether an XPath is a simple "//NAME" or "//@NAME" search
+ *
+ * \param[in]  xpath    XPath expression to check
+ * \param[out] is_attr  Where to store whether NAME is an attribute
+ *
+ * \return NAME if \p xpath is a simple descendant search, otherwise NULL
+ */
+static const char *
+simple_descendant_xpath(const char *xpath, bool *is_attr)
+{
+    static const char *name_chars = "abcdefghijklmnopqrstuvwxyz"
+                                    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                    "0123456789_-";
+    const char *name = NULL;
+
+    if (!crm_starts_with(xpath, "//")) {
+        return NULL;
+    }
+
+    name = xpath + 2;
+    *is_attr = (*name == '@');
+    if (*is_attr) {
+        name++;
+    }
+    if (!isalpha(*name) && (*name != '_')) {
+        return NULL;
+    }
+    if (name[strspn(name, name_chars)] != '\0') {
+        return NULL;
+    }
+    return name;
+}
+
+/*!
+ * \internal
+ * \brief Find elements matching a simple descendant search, without XPath
+ *
+ * \param[in]     xml      First sibling to search (along with descendants)
+ * \param[in]     name     Element or attribute name to search for
+ * \param[in]     is_attr  Whether \p name is an attribute name
+ * \param[out]    first    Where to store first match in document order
+ * \param[in,out] count    Number of matches so far (search stops at 2)
+ */
+static void
+find_simple_matches(xmlNode *xml, const char *name, bool is_attr,
+                    xmlNode **first, int *count)
+{
+    for (; (xml != NULL) && (*count < 2); xml = xml->next) {
+        bool match = false;
+
+        if (xml->type != XML_ELEMENT_NODE) {
+            continue;
+        }
+
+        if (is_attr) {
+            match = (xmlHasNsProp(xml, (pcmkXmlStr) name, NULL) != NULL);
+        } else {
+            match = (xml->ns == NULL)
+                    && (strcmp((const char *) xml->name, name) == 0);
+        }
+        if (match) {
+            if (*count == 0) {
+                *first = xml;
+            }
+            (*count)++;
+        }
+
+        find_simple_matches(xml->children, name, is_attr, first, count);
+    }
+}
+
 xmlNode *
 get_xpath_object(const char *xpath, xmlNode * xml_obj, int error_level)
 {
     int max;
+    bool is_attr = false;
+    const char *name = NULL;
     xmlNode *result = NULL;
     xmlXPathObjectPtr xpathObj = NULL;
     char *nodePath = NULL;
@@ -220,9 +361,30 @@ get_xpath_object(const char *xpath, xmlNode * xml_obj, int error_level)
         return xml_obj;         /* or return NULL? */
     }
 
+    /* Daemons look up fixed elements and attributes in every message this
+     * way, so handle those searches directly rather than via libxml2's XPath
+     * engine. Use the full search only when it's needed for logging.
+     */
+    name = simple_descendant_xpath(xpath, &is_attr);
+    if ((name != NULL) && (xml_obj != NULL)) {
+        xmlDoc *doc = getDocPtr(xml_obj);
+        int count = 0;
+
+        find_simple_matches(xmlDocGetRootElement(doc), name, is_attr,
+                            &result, &count);
+        if (count == 1) {
+            return result;
+        } else if (error_level >= LOG_NEVER) {
+            return NULL;
+        }
+        result = NULL;
+    }
+
     xpathObj = xpath_search(xml_obj, xpath);
-    nodePath = (char *)xmlGetNodePath(xml_obj);
     max = numXpathResults(xpathObj);
+    if ((max != 1) && (error_level < LOG_NEVER)) {
+        nodePath = (char *)xmlGetNodePath(xml_obj);
+    }
 
     if (max < 1) {
         if (error_level < LOG_NEVER) {
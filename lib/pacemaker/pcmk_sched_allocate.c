@@ -502,61 +502,42 @@ check_actions_for(xmlNode * rsc_entry, resource_t * rsc, node_t * node, pe_worki
     g_list_free(sorted_op_list);
 }
 
-static GListPtr
-find_rsc_list(GListPtr result, resource_t * rsc, const char *id, gboolean renamed_clones,
-              gboolean partial, pe_working_set_t * data_set)
+/*!
+ * \internal
+ * \brief Index primitive resources by ID and clone name
+ *
+ * \param[in,out] index  Table to add \p rsc and its descendants to
+ * \param[in]     rsc    Resource to index
+ *
+ * \note Each table value is a list of resources with that ID or clone name, in
+ *       the reverse of the order in which they are found in the resource tree.
+ */
+static void
+index_rsc_ids(GHashTable *index, pe_resource_t *rsc)
 {
-    GListPtr gIter = NULL;
-    gboolean match = FALSE;
-
-    if (id == NULL) {
-        return NULL;
-    }
-
-    if (rsc == NULL) {
-        if (data_set == NULL) {
-            return NULL;
-        }
-        for (gIter = data_set->resources; gIter != NULL; gIter = gIter->next) {
-            pe_resource_t *child = (pe_resource_t *) gIter->data;
-
-            result = find_rsc_list(result, child, id, renamed_clones, partial,
-                                   NULL);
-        }
-        return result;
-    }
-
-    if (partial) {
-        if (strstr(rsc->id, id)) {
-            match = TRUE;
-
-        } else if (renamed_clones && rsc->clone_name && strstr(rsc->clone_name, id)) {
-            match = TRUE;
-        }
-
-    } else {
-        if (strcmp(rsc->id, id) == 0) {
-            match = TRUE;
+    GList *gIter = NULL;
 
-        } else if (renamed_clones && rsc->clone_name && strcmp(rsc->clone_name, id) == 0) {
-            match = TRUE;
+    if (rsc->variant == pe_native) {
+        g_hash_table_insert(index, rsc->id,
+                            g_list_prepend(g_hash_table_lookup(index, rsc->id),
+                                           rsc));
+        if (rsc->clone_name && strcmp(rsc->clone_name, rsc->id)) {
+            g_hash_table_insert(index, rsc->clone_name,
+                                g_list_prepend(g_hash_table_lookup(index,
+                                                                   rsc->clone_name),
+                                               rsc));
         }
     }
 
-    if (match) {
-        result = g_list_prepend(result, rsc);
-    }
-
-    if (rsc->children) {
-        gIter = rsc->children;
-        for (; gIter != NULL; gIter = gIter->next) {
-            resource_t *child = (resource_t *) gIter->data;
-
-            result = find_rsc_list(result, child, id, renamed_clones, partial, NULL);
-        }
+    for (gIter = rsc->children; gIter != NULL; gIter = gIter->next) {
+        index_rsc_ids(index, (pe_resource_t *) gIter->data);
     }
+}
 
-    return result;
+static void
+free_rsc_id_list(gpointer key, gpointer value, gpointer user_data)
+{
+    g_list_free((GList *) value);
 }
 
 static void
@@ -568,6 +549,16 @@ check_actions(pe_working_set_t * data_set)
     xmlNode *status = get_object_root(XML_CIB_TAG_STATUS, data_set->input);
 
     xmlNode *node_state = NULL;
+    GHashTable *rsc_index = NULL;
+    GList *gIter = NULL;
+
+    /* Every node's history is matched against the resource tree, so index the
+     * tree once rather than searching all of it for each history entry
+     */
+    rsc_index = g_hash_table_new(crm_str_hash, g_str_equal);
+    for (gIter = data_set->resources; gIter != NULL; gIter = gIter->next) {
+        index_rsc_ids(rsc_index, (pe_resource_t *) gIter->data);
+    }
 
     for (node_state = __xml_first_child_element(status); node_state != NULL;
          node_state = __xml_next_element(node_state)) {
@@ -599,28 +590,26 @@ check_actions(pe_working_set_t * data_set)
                     if (crm_str_eq((const char *)rsc_entry->name, XML_LRM_TAG_RESOURCE, TRUE)) {
 
                         if (xml_has_children(rsc_entry)) {
-                            GListPtr gIter = NULL;
-                            GListPtr result = NULL;
                             const char *rsc_id = ID(rsc_entry);
 
-                            CRM_CHECK(rsc_id != NULL, return);
+                            CRM_CHECK(rsc_id != NULL, goto done);
 
-                            result = find_rsc_list(NULL, NULL, rsc_id, TRUE, FALSE, data_set);
-                            for (gIter = result; gIter != NULL; gIter = gIter->next) {
+                            for (gIter = g_hash_table_lookup(rsc_index, rsc_id);
+                                 gIter != NULL; gIter = gIter->next) {
                                 resource_t *rsc = (resource_t *) gIter->data;
 
-                                if (rsc->variant != pe_native) {
-                                    continue;
-                                }
                                 check_actions_for(rsc_entry, rsc, node, data_set);
                             }
-                            g_list_free(result);
                         }
                     }
                 }
             }
         }
     }
+
+done:
+    g_hash_table_foreach(rsc_index, free_rsc_id_list, NULL);
+    g_hash_table_destroy(rsc_index);
 }
 
 static void
@@ -1394,6 +1383,7 @@ stage5(pe_working_set_t * data_set)
     GListPtr gIter = NULL;
     int log_prio = show_utilization? LOG_STDOUT : utilization_log_level;
 
+    pcmk__unpack_utilization(data_set);
     if (safe_str_neq(data_set->placement_strategy, "default")) {
         GListPtr nodes = g_list_copy(data_set->nodes);
 
@@ -1420,6 +1410,7 @@ stage5(pe_working_set_t * data_set)
     for (; gIter != NULL; gIter = gIter->next) {
         node_t *node = (node_t *) gIter->data;
 
+        pcmk__sync_utilization(node, data_set);
         dump_node_capacity(log_prio, "Remaining", node);
     }
 
@@ -2913,6 +2904,26 @@ pcmk__log_transition_summary(const char *filename)
     }
 }
 
+/*!
+ * \internal
+ * \brief Reuse a previously calculated transition graph as a new transition
+ *
+ * \param[in] graph  Transition graph XML created by an earlier stage8()
+ *
+ * \return Newly allocated copy of \p graph with the next transition ID
+ * \note The controller identifies actions by transition ID, so a reused graph
+ *       must never be sent with the ID of the transition it came from.
+ */
+xmlNode *
+pcmk__copy_transition_graph(xmlNode *graph)
+{
+    xmlNode *copy = copy_xml(graph);
+
+    transition_id++;
+    crm_xml_add_int(copy, "transition_id", transition_id);
+    return copy;
+}
+
 /*
  * Create a dependency graph to send to the transitioner (via the controller)
  */
@@ -1596,7 +1596,8 @@ custom_action_order(resource_t * lh_rsc, char *lh_action_task, action_t * lh_act
         return -1;
     }
 
-    order = calloc(1, sizeof(pe__ordering_t));
+    order = pe__arena_alloc(pe__working_set_arena(data_set),
+                            sizeof(pe__ordering_t));
 
     crm_trace("Creating[%d] %s %s %s - %s %s %s", data_set->order_id,
               lh_rsc?lh_rsc->id:"NA", lh_action_task, lh_action?lh_action->uuid:"NA",
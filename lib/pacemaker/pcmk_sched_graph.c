@@ -1761,7 +1761,9 @@ deduplicate_inputs(pe_action_t *action)
                 last_input->state = pe_link_dumped;
             }
 
-            free(item->data);
+            if (action->arena == NULL) {
+                free(item->data);
+            }
             action->actions_before = g_list_delete_link(action->actions_before,
                                                         item);
         } else {
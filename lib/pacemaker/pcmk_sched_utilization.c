@@ -1,5 +1,5 @@
 /*
- * Copyright 2014-2019 the Pacemaker project contributors
+ * Copyright 2014-2020 the Pacemaker project contributors
  *
  * The version control history for this file may have further details.
  *
@@ -17,165 +17,299 @@ static GListPtr find_colocated_rscs(GListPtr colocated_rscs, resource_t * rsc,
 static GListPtr group_find_colocated_rscs(GListPtr colocated_rscs, resource_t * rsc,
                                           resource_t * orig_rsc);
 
-static void group_add_unallocated_utilization(GHashTable * all_utilization, resource_t * rsc,
+static void group_add_unallocated_utilization(pcmk__utilization_t *all_utilization,
+                                              resource_t * rsc,
                                               GListPtr all_rscs);
 
-struct compare_data {
-    const node_t *node1;
-    const node_t *node2;
-    int result;
-};
+static pcmk__utilization_t *
+new_utilization(int count)
+{
+    pcmk__utilization_t *utilization = NULL;
+
+    utilization = calloc(1, sizeof(pcmk__utilization_t)
+                            + count * sizeof(utilization->attrs[0]));
+    CRM_ASSERT(utilization != NULL);
+    utilization->count = count;
+    return utilization;
+}
+
+/*!
+ * \internal
+ * \brief Convert a utilization table to numeric form
+ *
+ * \param[in] table  Utilization table (name -> value string)
+ * \param[in] index  Utilization name -> 1-based vector index
+ * \param[in] count  Number of utilization attributes
+ *
+ * \return Newly allocated numeric utilization
+ */
+static pcmk__utilization_t *
+unpack_utilization_table(GHashTable *table, GHashTable *index, int count)
+{
+    GHashTableIter iter;
+    const char *name = NULL;
+    const char *value = NULL;
+    pcmk__utilization_t *utilization = new_utilization(count);
+
+    g_hash_table_iter_init(&iter, table);
+    while (g_hash_table_iter_next(&iter, (gpointer *) &name,
+                                  (gpointer *) &value)) {
+        int i = GPOINTER_TO_INT(g_hash_table_lookup(index, name)) - 1;
+
+        utilization->attrs[i].value = crm_parse_int(value, "0");
+        utilization->attrs[i].set = true;
+    }
+    return utilization;
+}
 
 static void
-do_compare_capacity1(gpointer key, gpointer value, gpointer user_data)
+index_utilization_names(GHashTable *table, GHashTable *index,
+                        pe_working_set_t *data_set)
 {
-    int node1_capacity = 0;
-    int node2_capacity = 0;
-    struct compare_data *data = user_data;
-
-    node1_capacity = crm_parse_int(value, "0");
-    node2_capacity =
-        crm_parse_int(g_hash_table_lookup(data->node2->details->utilization, key), "0");
-
-    if (node1_capacity > node2_capacity) {
-        data->result--;
-    } else if (node1_capacity < node2_capacity) {
-        data->result++;
+    GHashTableIter iter;
+    char *name = NULL;
+
+    g_hash_table_iter_init(&iter, table);
+    while (g_hash_table_iter_next(&iter, (gpointer *) &name, NULL)) {
+        if (g_hash_table_lookup(index, name) == NULL) {
+            g_ptr_array_add(data_set->utilization_names, strdup(name));
+            g_hash_table_insert(index, name,
+                                GINT_TO_POINTER(data_set->utilization_names->len));
+        }
     }
 }
 
 static void
-do_compare_capacity2(gpointer key, gpointer value, gpointer user_data)
+index_rsc_utilization_names(GListPtr resources, GHashTable *index,
+                            pe_working_set_t *data_set)
 {
-    int node1_capacity = 0;
-    int node2_capacity = 0;
-    struct compare_data *data = user_data;
+    for (GListPtr iter = resources; iter != NULL; iter = iter->next) {
+        resource_t *rsc = (resource_t *) iter->data;
 
-    if (g_hash_table_lookup_extended(data->node1->details->utilization, key, NULL, NULL)) {
-        return;
+        index_utilization_names(rsc->utilization, index, data_set);
+        index_rsc_utilization_names(rsc->children, index, data_set);
     }
+}
 
-    node1_capacity = 0;
-    node2_capacity = crm_parse_int(value, "0");
-
-    if (node1_capacity > node2_capacity) {
-        data->result--;
-    } else if (node1_capacity < node2_capacity) {
-        data->result++;
+static void
+unpack_rsc_utilization(GListPtr resources, GHashTable *index,
+                       pe_working_set_t *data_set)
+{
+    for (GListPtr iter = resources; iter != NULL; iter = iter->next) {
+        resource_t *rsc = (resource_t *) iter->data;
+
+        free(rsc->utilization_values);
+        rsc->utilization_values = unpack_utilization_table(rsc->utilization,
+                                                           index,
+                                                           data_set->utilization_names->len);
+        unpack_rsc_utilization(rsc->children, index, data_set);
     }
 }
 
-/* rc < 0 if 'node1' has more capacity remaining
- * rc > 0 if 'node1' has less capacity remaining
+/*!
+ * \internal
+ * \brief Convert all node capacities and resource utilizations to numeric form
+ *
+ * Utilization attribute names are mapped to a dense index, so that capacity
+ * checks and bookkeeping during allocation work on arrays of numbers rather
+ * than parsing and formatting strings in hash tables.
+ *
+ * \param[in,out] data_set  Cluster working set
+ *
+ * \note This does nothing if it has already been done for \p data_set.
  */
-int
-compare_capacity(const node_t * node1, const node_t * node2)
+void
+pcmk__unpack_utilization(pe_working_set_t *data_set)
 {
-    struct compare_data data;
+    GHashTable *index = NULL;
 
-    data.node1 = node1;
-    data.node2 = node2;
-    data.result = 0;
+    if (data_set->utilization_names != NULL) {
+        return;
+    }
 
-    g_hash_table_foreach(node1->details->utilization, do_compare_capacity1, &data);
-    g_hash_table_foreach(node2->details->utilization, do_compare_capacity2, &data);
+    // Name -> 1-based index in vectors (names are borrowed from tables)
+    index = g_hash_table_new(crm_str_hash, g_str_equal);
+    data_set->utilization_names = g_ptr_array_new_with_free_func(free);
 
-    return data.result;
-}
+    for (GListPtr iter = data_set->nodes; iter != NULL; iter = iter->next) {
+        node_t *node = (node_t *) iter->data;
 
-struct calculate_data {
-    GHashTable *current_utilization;
-    gboolean plus;
-};
+        index_utilization_names(node->details->utilization, index, data_set);
+    }
+    index_rsc_utilization_names(data_set->resources, index, data_set);
 
-static void
-do_calculate_utilization(gpointer key, gpointer value, gpointer user_data)
-{
-    const char *current = NULL;
-    char *result = NULL;
-    struct calculate_data *data = user_data;
-
-    current = g_hash_table_lookup(data->current_utilization, key);
-    if (data->plus) {
-        result = crm_itoa(crm_parse_int(current, "0") + crm_parse_int(value, "0"));
-        g_hash_table_replace(data->current_utilization, strdup(key), result);
-
-    } else if (current) {
-        result = crm_itoa(crm_parse_int(current, "0") - crm_parse_int(value, "0"));
-        g_hash_table_replace(data->current_utilization, strdup(key), result);
+    for (GListPtr iter = data_set->nodes; iter != NULL; iter = iter->next) {
+        node_t *node = (node_t *) iter->data;
+
+        free(node->details->utilization_values);
+        node->details->utilization_values =
+            unpack_utilization_table(node->details->utilization, index,
+                                     data_set->utilization_names->len);
     }
+    unpack_rsc_utilization(data_set->resources, index, data_set);
+
+    crm_trace("Indexed %u utilization attribute%s",
+              data_set->utilization_names->len,
+              pcmk__plural_s(data_set->utilization_names->len));
+    g_hash_table_destroy(index);
 }
 
-/* Specify 'plus' to FALSE when allocating
- * Otherwise to TRUE when deallocating
+/*!
+ * \internal
+ * \brief Update a node's utilization table from its numeric utilization
+ *
+ * \param[in,out] node      Node to update
+ * \param[in]     data_set  Cluster working set
  */
 void
-calculate_utilization(GHashTable * current_utilization,
-                      GHashTable * utilization, gboolean plus)
+pcmk__sync_utilization(pe_node_t *node, pe_working_set_t *data_set)
 {
-    struct calculate_data data;
+    pcmk__utilization_t *utilization = node->details->utilization_values;
+
+    if ((utilization == NULL) || (data_set->utilization_names == NULL)) {
+        return;
+    }
 
-    data.current_utilization = current_utilization;
-    data.plus = plus;
+    for (int i = 0; i < utilization->count; i++) {
+        if (utilization->attrs[i].set) {
+            const char *name = g_ptr_array_index(data_set->utilization_names, i);
+            char *value = crm_itoa((int) utilization->attrs[i].value);
 
-    g_hash_table_foreach(utilization, do_calculate_utilization, &data);
+            if (safe_str_eq(value, g_hash_table_lookup(node->details->utilization,
+                                                       name))) {
+                free(value);
+            } else {
+                g_hash_table_replace(node->details->utilization, strdup(name),
+                                     value);
+            }
+        }
+    }
 }
 
+static inline long long
+utilization_value(const pcmk__utilization_t *utilization, int i)
+{
+    return ((utilization == NULL) || (i >= utilization->count))?
+           0 : utilization->attrs[i].value;
+}
 
-struct capacity_data {
-    node_t *node;
-    const char *rsc_id;
-    gboolean is_enough;
-};
+/* rc < 0 if 'node1' has more capacity remaining
+ * rc > 0 if 'node1' has less capacity remaining
+ */
+int
+compare_capacity(const node_t * node1, const node_t * node2)
+{
+    int result = 0;
+    const pcmk__utilization_t *capacity1 = node1->details->utilization_values;
+    const pcmk__utilization_t *capacity2 = node2->details->utilization_values;
+    int count = QB_MAX((capacity1? capacity1->count : 0),
+                       (capacity2? capacity2->count : 0));
+
+    /* An attribute set on neither node compares as equal, so this gives the
+     * same result as comparing over the attributes set on either node
+     */
+    for (int i = 0; i < count; i++) {
+        long long node1_capacity = utilization_value(capacity1, i);
+        long long node2_capacity = utilization_value(capacity2, i);
+
+        if (node1_capacity > node2_capacity) {
+            result--;
+        } else if (node1_capacity < node2_capacity) {
+            result++;
+        }
+    }
+    return result;
+}
 
+/*!
+ * \internal
+ * \brief Add or subtract utilization from a numeric utilization vector
+ *
+ * \param[in,out] current      Utilization to update
+ * \param[in]     utilization  Utilization to add or subtract
+ * \param[in]     plus         If TRUE, add (attributes not yet set in
+ *                             \p current become set), otherwise subtract
+ *                             (only from attributes set in \p current)
+ */
 static void
-check_capacity(gpointer key, gpointer value, gpointer user_data)
+add_utilization(pcmk__utilization_t *current,
+                const pcmk__utilization_t *utilization, gboolean plus)
 {
-    int required = 0;
-    int remaining = 0;
-    struct capacity_data *data = user_data;
+    if ((current == NULL) || (utilization == NULL)) {
+        return;
+    }
 
-    required = crm_parse_int(value, "0");
-    remaining = crm_parse_int(g_hash_table_lookup(data->node->details->utilization, key), "0");
+    CRM_CHECK(current->count == utilization->count, return);
+    for (int i = 0; i < utilization->count; i++) {
+        if (!utilization->attrs[i].set) {
+            continue;
 
-    if (required > remaining) {
-        CRM_ASSERT(data->rsc_id);
-        CRM_ASSERT(data->node);
+        } else if (plus) {
+            current->attrs[i].value += utilization->attrs[i].value;
+            current->attrs[i].set = true;
 
-        crm_debug("Node %s does not have enough %s for %s: required=%d remaining=%d",
-                  data->node->details->uname, (char *)key, data->rsc_id, required, remaining);
-        data->is_enough = FALSE;
+        } else if (current->attrs[i].set) {
+            current->attrs[i].value -= utilization->attrs[i].value;
+        }
     }
 }
 
+/* Specify 'plus' to FALSE when allocating
+ * Otherwise to TRUE when deallocating
+ */
+void
+calculate_utilization(pe_node_t *node, pe_resource_t *rsc, gboolean plus)
+{
+    pcmk__unpack_utilization(rsc->cluster);
+    add_utilization(node->details->utilization_values, rsc->utilization_values,
+                    plus);
+}
+
 static gboolean
-have_enough_capacity(node_t * node, const char * rsc_id, GHashTable * utilization)
+have_enough_capacity(node_t * node, const char * rsc_id,
+                     const pcmk__utilization_t *utilization,
+                     pe_working_set_t *data_set)
 {
-    struct capacity_data data;
+    gboolean is_enough = TRUE;
+    const pcmk__utilization_t *capacity = node->details->utilization_values;
+
+    if (utilization == NULL) {
+        return TRUE;
+    }
 
-    data.node = node;
-    data.rsc_id = rsc_id;
-    data.is_enough = TRUE;
+    for (int i = 0; i < utilization->count; i++) {
+        long long required = utilization->attrs[i].value;
+        long long remaining = utilization_value(capacity, i);
 
-    g_hash_table_foreach(utilization, check_capacity, &data);
+        if (utilization->attrs[i].set && (required > remaining)) {
+            CRM_ASSERT(rsc_id);
 
-    return data.is_enough;
+            crm_debug("Node %s does not have enough %s for %s: required=%lld remaining=%lld",
+                      node->details->uname,
+                      (const char *) g_ptr_array_index(data_set->utilization_names, i),
+                      rsc_id, required, remaining);
+            is_enough = FALSE;
+        }
+    }
+    return is_enough;
 }
 
 
 static void
-native_add_unallocated_utilization(GHashTable * all_utilization, resource_t * rsc)
+native_add_unallocated_utilization(pcmk__utilization_t *all_utilization,
+                                   resource_t * rsc)
 {
     if(is_set(rsc->flags, pe_rsc_provisional) == FALSE) {
         return;
     }
 
-    calculate_utilization(all_utilization, rsc->utilization, TRUE);
+    add_utilization(all_utilization, rsc->utilization_values, TRUE);
 }
 
 static void
-add_unallocated_utilization(GHashTable * all_utilization, resource_t * rsc,
-                    GListPtr all_rscs, resource_t * orig_rsc)
+add_unallocated_utilization(pcmk__utilization_t *all_utilization,
+                            resource_t * rsc, GListPtr all_rscs,
+                            resource_t * orig_rsc)
 {
     if(is_set(rsc->flags, pe_rsc_provisional) == FALSE) {
         return;
@@ -232,12 +366,13 @@ add_unallocated_utilization(GHashTable * all_utilization, resource_t * rsc,
     }
 }
 
-static GHashTable *
+static pcmk__utilization_t *
 sum_unallocated_utilization(resource_t * rsc, GListPtr colocated_rscs)
 {
     GListPtr gIter = NULL;
     GListPtr all_rscs = NULL;
-    GHashTable *all_utilization = crm_str_table_new();
+    pcmk__utilization_t *all_utilization =
+        new_utilization(rsc->cluster->utilization_names->len);
 
     all_rscs = g_list_copy(colocated_rscs);
     if (g_list_find(all_rscs, rsc) == FALSE) {
@@ -337,9 +472,11 @@ process_utilization(resource_t * rsc, node_t ** prefer, pe_working_set_t * data_
         gboolean any_capable = FALSE;
         node_t *node = NULL;
 
+        pcmk__unpack_utilization(data_set);
+
         colocated_rscs = find_colocated_rscs(colocated_rscs, rsc, rsc);
         if (colocated_rscs) {
-            GHashTable *unallocated_utilization = NULL;
+            pcmk__utilization_t *unallocated_utilization = NULL;
             char *rscs_id = crm_concat(rsc->id, "and its colocated resources", ' ');
             node_t *most_capable_node = NULL;
 
@@ -351,7 +488,8 @@ process_utilization(resource_t * rsc, node_t ** prefer, pe_working_set_t * data_
                     continue;
                 }
 
-                if (have_enough_capacity(node, rscs_id, unallocated_utilization)) {
+                if (have_enough_capacity(node, rscs_id, unallocated_utilization,
+                                         data_set)) {
                     any_capable = TRUE;
                 }
 
@@ -369,7 +507,9 @@ process_utilization(resource_t * rsc, node_t ** prefer, pe_working_set_t * data_
                         continue;
                     }
 
-                    if (have_enough_capacity(node, rscs_id, unallocated_utilization) == FALSE) {
+                    if (have_enough_capacity(node, rscs_id,
+                                             unallocated_utilization,
+                                             data_set) == FALSE) {
                         pe_rsc_debug(rsc,
                                      "Resource %s and its colocated resources"
                                      " cannot be allocated to node %s: not enough capacity",
@@ -382,9 +522,7 @@ process_utilization(resource_t * rsc, node_t ** prefer, pe_working_set_t * data_
                 *prefer = most_capable_node;
             }
 
-            if (unallocated_utilization) {
-                g_hash_table_destroy(unallocated_utilization);
-            }
+            free(unallocated_utilization);
 
             g_list_free(colocated_rscs);
             free(rscs_id);
@@ -397,7 +535,9 @@ process_utilization(resource_t * rsc, node_t ** prefer, pe_working_set_t * data_
                     continue;
                 }
 
-                if (have_enough_capacity(node, rsc->id, rsc->utilization) == FALSE) {
+                if (have_enough_capacity(node, rsc->id,
+                                         rsc->utilization_values,
+                                         data_set) == FALSE) {
                     pe_rsc_debug(rsc,
                                  "Resource %s cannot be allocated to node %s:"
                                  " not enough capacity",
@@ -440,8 +580,8 @@ group_find_colocated_rscs(GListPtr colocated_rscs, resource_t * rsc, resource_t
 }
 
 static void
-group_add_unallocated_utilization(GHashTable * all_utilization, resource_t * rsc,
-                                  GListPtr all_rscs)
+group_add_unallocated_utilization(pcmk__utilization_t *all_utilization,
+                                  resource_t * rsc, GListPtr all_rscs)
 {
     group_variant_data_t *group_data = NULL;
 
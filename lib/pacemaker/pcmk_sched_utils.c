@@ -205,7 +205,7 @@ native_deallocate(resource_t * rsc)
         old->details->allocated_rsc = g_list_remove(old->details->allocated_rsc, rsc);
         old->details->num_resources--;
         /* old->count--; */
-        calculate_utilization(old->details->utilization, rsc->utilization, TRUE);
+        calculate_utilization(old, rsc, TRUE);
         free(old);
     }
 }
@@ -282,7 +282,7 @@ native_assign_node(resource_t * rsc, GListPtr nodes, node_t * chosen, gboolean f
     chosen->details->allocated_rsc = g_list_prepend(chosen->details->allocated_rsc, rsc);
     chosen->details->num_resources++;
     chosen->count++;
-    calculate_utilization(chosen->details->utilization, rsc->utilization, FALSE);
+    calculate_utilization(chosen, rsc, FALSE);
     dump_rsc_utilization((show_utilization? LOG_STDOUT : utilization_log_level),
                          __FUNCTION__, rsc, chosen);
 
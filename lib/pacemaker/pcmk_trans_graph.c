@@ -16,36 +16,34 @@
 
 crm_graph_functions_t *graph_fns = NULL;
 
-static gboolean
-update_synapse_ready(synapse_t * synapse, int action_id)
+static gint
+sort_synapse_id(gconstpointer a, gconstpointer b)
 {
-    GListPtr lpc = NULL;
-    gboolean updates = FALSE;
+    return ((const synapse_t *) a)->id - ((const synapse_t *) b)->id;
+}
 
+static gboolean
+update_synapse_ready(crm_graph_t * graph, synapse_t * synapse,
+                     crm_action_t * prereq)
+{
     CRM_CHECK(synapse->executed == FALSE, return FALSE);
     CRM_CHECK(synapse->confirmed == FALSE, return FALSE);
 
-    synapse->ready = TRUE;
-    for (lpc = synapse->inputs; lpc != NULL; lpc = lpc->next) {
-        crm_action_t *prereq = (crm_action_t *) lpc->data;
-
-        crm_trace("Processing input %d", prereq->id);
-
-        if (prereq->id == action_id) {
-            crm_trace("Marking input %d of synapse %d confirmed", action_id, synapse->id);
-            prereq->confirmed = TRUE;
-            updates = TRUE;
+    crm_trace("Marking input %d of synapse %d confirmed", prereq->id, synapse->id);
+    if (prereq->confirmed == FALSE) {
+        prereq->confirmed = TRUE;
+        synapse->pending_inputs--;
 
-        } else if (prereq->confirmed == FALSE) {
-            synapse->ready = FALSE;
+        if (synapse->pending_inputs == 0) {
+            // Keep ready synapses in graph order, so they fire as before
+            graph->ready = g_list_insert_sorted(graph->ready, synapse,
+                                                sort_synapse_id);
         }
-
     }
 
-    if (updates) {
-        crm_trace("Updated synapse %d", synapse->id);
-    }
-    return updates;
+    synapse->ready = (synapse->pending_inputs == 0);
+    crm_trace("Updated synapse %d", synapse->id);
+    return TRUE;
 }
 
 static gboolean
@@ -90,24 +88,29 @@ update_synapse_confirmed(synapse_t * synapse, int action_id)
 gboolean
 update_graph(crm_graph_t * graph, crm_action_t * action)
 {
-    gboolean rc = FALSE;
     gboolean updates = FALSE;
-    GListPtr lpc = NULL;
+    gpointer key = GINT_TO_POINTER(action->id);
+    synapse_t *owner = g_hash_table_lookup(graph->owners, key);
 
-    for (lpc = graph->synapses; lpc != NULL; lpc = lpc->next) {
-        synapse_t *synapse = (synapse_t *) lpc->data;
+    // Only the synapse containing the action can be confirmed by it
+    if ((owner != NULL) && owner->executed
+        && (owner->confirmed == FALSE) && (owner->failed == FALSE)) {
+        updates = update_synapse_confirmed(owner, action->id);
+    }
 
-        if (synapse->confirmed || synapse->failed) {
-            crm_trace("Synapse complete");
+    // Only synapses with the action as an input can become ready
+    for (GList *lpc = g_hash_table_lookup(graph->dependents, key);
+         lpc != NULL; lpc = lpc->next) {
 
-        } else if (synapse->executed) {
-            crm_trace("Synapse executed");
-            rc = update_synapse_confirmed(synapse, action->id);
+        crm_action_t *prereq = (crm_action_t *) lpc->data;
+        synapse_t *synapse = prereq->synapse;
+
+        if (synapse->confirmed || synapse->failed || synapse->executed) {
+            crm_trace("Synapse %d already handled", synapse->id);
 
         } else if (action->failed == FALSE || synapse->priority == INFINITY) {
-            rc = update_synapse_ready(synapse, action->id);
+            updates |= update_synapse_ready(graph, synapse, prereq);
         }
-        updates = updates || rc;
     }
 
     if (updates) {
@@ -232,6 +235,23 @@ fire_synapse(crm_graph_t * graph, synapse_t * synapse)
     return TRUE;
 }
 
+// Drop synapses that no longer need to be considered for firing
+static void
+prune_ready_synapses(crm_graph_t * graph)
+{
+    GList *lpc = graph->ready;
+
+    while (lpc != NULL) {
+        GList *next = lpc->next;
+        synapse_t *synapse = (synapse_t *) lpc->data;
+
+        if (synapse->failed || synapse->confirmed || synapse->executed) {
+            graph->ready = g_list_delete_link(graph->ready, lpc);
+        }
+        lpc = next;
+    }
+}
+
 int
 run_graph(crm_graph_t * graph)
 {
@@ -267,20 +287,24 @@ run_graph(crm_graph_t * graph)
             crm_trace("Synapse %d: confirmation pending", synapse->id);
             graph->pending++;
         }
+
+        if (synapse->failed) {
+            graph->skipped++;
+        }
     }
 
-    /* Now check if there is work to do */
-    for (lpc = graph->synapses; lpc != NULL; lpc = lpc->next) {
+    /* Now check if there is work to do. Only synapses whose inputs have all
+     * been confirmed can fire. Synapses that become ready while this runs are
+     * added in graph order, so later ones are handled in this same pass.
+     */
+    for (lpc = graph->ready; lpc != NULL; lpc = lpc->next) {
         synapse_t *synapse = (synapse_t *) lpc->data;
 
         if (graph->batch_limit > 0 && graph->pending >= graph->batch_limit) {
             crm_debug("Throttling output: batch limit (%d) reached", graph->batch_limit);
             break;
-        } else if (synapse->failed) {
-            graph->skipped++;
-            continue;
 
-        } else if (synapse->confirmed || synapse->executed) {
+        } else if (synapse->failed || synapse->confirmed || synapse->executed) {
             /* Already handled */
             continue;
         }
@@ -305,6 +329,18 @@ run_graph(crm_graph_t * graph)
             graph->incomplete++;
         }
     }
+    prune_ready_synapses(graph);
+
+    /* Synapses still waiting for inputs can't fire either */
+    for (lpc = graph->synapses; lpc != NULL; lpc = lpc->next) {
+        synapse_t *synapse = (synapse_t *) lpc->data;
+
+        if ((synapse->pending_inputs > 0) && (synapse->failed == FALSE)
+            && (synapse->confirmed == FALSE) && (synapse->executed == FALSE)) {
+            crm_trace("Synapse %d cannot fire", synapse->id);
+            graph->incomplete++;
+        }
+    }
 
     if (graph->pending == 0 && graph->fired == 0) {
         graph->complete = TRUE;
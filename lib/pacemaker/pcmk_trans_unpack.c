@@ -79,6 +79,26 @@ unpack_action(synapse_t * parent, xmlNode * xml_action)
     return action;
 }
 
+/*!
+ * \internal
+ * \brief Index a synapse input by the ID of the action it waits for
+ *
+ * \param[in,out] graph  Graph being unpacked
+ * \param[in]     input  Newly unpacked synapse input
+ */
+static void
+add_dependent(crm_graph_t *graph, crm_action_t *input)
+{
+    gpointer key = GINT_TO_POINTER(input->id);
+    GList *inputs = g_hash_table_lookup(graph->dependents, key);
+
+    if (inputs != NULL) {
+        // Steal the entry, otherwise replacing it would free the list
+        g_hash_table_steal(graph->dependents, key);
+    }
+    g_hash_table_insert(graph->dependents, key, g_list_prepend(inputs, input));
+}
+
 static synapse_t *
 unpack_synapse(crm_graph_t * new_graph, xmlNode * xml_synapse)
 {
@@ -123,6 +143,9 @@ unpack_synapse(crm_graph_t * new_graph, xmlNode * xml_synapse)
                 crm_trace("Adding action %d to synapse %d", new_action->id, new_synapse->id);
 
                 new_synapse->actions = g_list_append(new_synapse->actions, new_action);
+                g_hash_table_insert(new_graph->owners,
+                                    GINT_TO_POINTER(new_action->id),
+                                    new_synapse);
             }
         }
     }
@@ -147,6 +170,8 @@ unpack_synapse(crm_graph_t * new_graph, xmlNode * xml_synapse)
                     crm_trace("Adding input %d to synapse %d", new_input->id, new_synapse->id);
 
                     new_synapse->inputs = g_list_append(new_synapse->inputs, new_input);
+                    new_synapse->pending_inputs++;
+                    add_dependent(new_graph, new_input);
                 }
             }
         }
@@ -214,15 +239,27 @@ unpack_graph(xmlNode * xml_graph, const char *reference)
         new_graph->migration_limit = crm_parse_int(t_id, "-1");
     }
 
+    new_graph->owners = g_hash_table_new(g_direct_hash, g_direct_equal);
+    new_graph->dependents = g_hash_table_new_full(g_direct_hash,
+                                                  g_direct_equal, NULL,
+                                                  (GDestroyNotify) g_list_free);
+
     for (synapse = __xml_first_child(xml_graph); synapse != NULL; synapse = __xml_next(synapse)) {
         if (crm_str_eq((const char *)synapse->name, "synapse", TRUE)) {
             synapse_t *new_synapse = unpack_synapse(new_graph, synapse);
 
             if (new_synapse != NULL) {
-                new_graph->synapses = g_list_append(new_graph->synapses, new_synapse);
+                new_graph->synapses = g_list_prepend(new_graph->synapses,
+                                                     new_synapse);
+                if (new_synapse->pending_inputs == 0) {
+                    new_graph->ready = g_list_prepend(new_graph->ready,
+                                                      new_synapse);
+                }
             }
         }
     }
+    new_graph->synapses = g_list_reverse(new_graph->synapses);
+    new_graph->ready = g_list_reverse(new_graph->ready);
 
     crm_debug("Unpacked transition %d: %d actions in %d synapses",
               new_graph->id, new_graph->num_actions, new_graph->num_synapses);
@@ -277,6 +314,9 @@ destroy_graph(crm_graph_t * graph)
         destroy_synapse(synapse);
     }
 
+    g_hash_table_destroy(graph->owners);
+    g_hash_table_destroy(graph->dependents);
+    g_list_free(graph->ready);
     free(graph->source);
     free(graph);
 }
@@ -803,6 +803,7 @@ common_free(resource_t * rsc)
     if (rsc->utilization != NULL) {
         g_hash_table_destroy(rsc->utilization);
     }
+    free(rsc->utilization_values);
 
     if (rsc->parent == NULL && is_set(rsc->flags, pe_rsc_orphan)) {
         free_xml(rsc->xml);
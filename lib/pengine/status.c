@@ -208,6 +208,7 @@ pe_free_nodes(GListPtr nodes)
         if (node->details->digest_cache != NULL) {
             g_hash_table_destroy(node->details->digest_cache);
         }
+        free(node->details->utilization_values);
         g_list_free(node->details->running_rsc);
         g_list_free(node->details->allocated_rsc);
         free(node->details);
@@ -219,7 +220,7 @@ pe_free_nodes(GListPtr nodes)
 }
 
 static void
-pe__free_ordering(GListPtr constraints)
+pe__free_ordering(GListPtr constraints, pe__arena_t *arena)
 {
     GListPtr iterator = constraints;
 
@@ -230,7 +231,9 @@ pe__free_ordering(GListPtr constraints)
 
         free(order->lh_action_task);
         free(order->rh_action_task);
-        free(order);
+        if (arena == NULL) {
+            free(order);
+        }
     }
     if (constraints != NULL) {
         g_list_free(constraints);
@@ -280,6 +283,18 @@ cleanup_calculations(pe_working_set_t * data_set)
         g_hash_table_destroy(data_set->singletons);
     }
 
+    if (data_set->action_index != NULL) {
+        g_hash_table_destroy(data_set->action_index);
+    }
+
+    if (data_set->interned != NULL) {
+        g_hash_table_destroy(data_set->interned);
+    }
+
+    if (data_set->utilization_names != NULL) {
+        g_ptr_array_free(data_set->utilization_names, TRUE);
+    }
+
     if (data_set->tickets) {
         g_hash_table_destroy(data_set->tickets);
     }
@@ -310,6 +325,9 @@ cleanup_calculations(pe_working_set_t * data_set)
     free_xml(data_set->input);
     free_xml(data_set->failed);
 
+    // Must be after anything that might have been allocated from it
+    pe__arena_free(data_set->arena);
+
     set_working_set_defaults(data_set);
 
     CRM_CHECK(data_set->ordering_constraints == NULL,;
@@ -332,7 +350,7 @@ pe_reset_working_set(pe_working_set_t *data_set)
 
     crm_trace("Deleting %d ordering constraints",
               g_list_length(data_set->ordering_constraints));
-    pe__free_ordering(data_set->ordering_constraints);
+    pe__free_ordering(data_set->ordering_constraints, data_set->arena);
     data_set->ordering_constraints = NULL;
 
     crm_trace("Deleting %d location constraints",
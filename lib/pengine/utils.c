@@ -14,6 +14,7 @@
 #include <crm/common/util.h>
 
 #include <ctype.h>
+#include <stdint.h>
 #include <glib.h>
 #include <stdbool.h>
 
@@ -29,6 +30,8 @@ void unpack_operation(action_t * action, xmlNode * xml_obj, resource_t * contain
                       pe_working_set_t * data_set);
 static xmlNode *find_rsc_op_entry_helper(resource_t * rsc, const char *key,
                                          gboolean include_disabled);
+static GList *find_matching_actions(GList *input, const pe_resource_t *rsc,
+                                    const char *key, const pe_node_t *on_node);
 
 #if ENABLE_VERSIONED_ATTRS
 pe_rsc_action_details_t *
@@ -497,6 +500,107 @@ sort_rsc_priority(gconstpointer a, gconstpointer b)
     return 0;
 }
 
+/*!
+ * \internal
+ * \brief Add a newly saved action to its working set's action index
+ *
+ * \param[in]     action    Action to index
+ * \param[in,out] data_set  Working set that action was saved in
+ */
+static void
+index_action(pe_action_t *action, pe_working_set_t *data_set)
+{
+    GList *matches = NULL;
+
+    if (data_set->action_index == NULL) {
+        // Keys are interned, so they can be compared by address
+        data_set->action_index = g_hash_table_new_full(g_direct_hash,
+                                                       g_direct_equal, NULL,
+                                                       (GDestroyNotify) g_list_free);
+    }
+
+    /* Prepend, so each entry is in the same relative order as
+     * data_set->actions and rsc->actions (newest first). The entry must be
+     * stolen first, otherwise replacing it would free the list.
+     */
+    matches = g_hash_table_lookup(data_set->action_index, action->uuid);
+    if (matches != NULL) {
+        g_hash_table_steal(data_set->action_index, action->uuid);
+    }
+    g_hash_table_insert(data_set->action_index, action->uuid,
+                        g_list_prepend(matches, action));
+}
+
+/*!
+ * \internal
+ * \brief Narrow an action list to the indexed actions with a given key
+ *
+ * If \p input is a resource's action list or a working set's action list,
+ * replace it with the (much shorter) list of saved actions with \p key, so
+ * that the caller does not need to scan every action.
+ *
+ * If the key has been interned, it is also replaced with its canonical copy,
+ * so that the caller's comparisons can usually be done by address.
+ *
+ * \param[in,out] input  Action list to search (may be replaced)
+ * \param[in,out] key    Action key being searched for (may be replaced)
+ * \param[out]    rsc    If \p input was narrowed to a resource's actions,
+ *                       matches must belong to this resource
+ */
+static void
+narrow_to_index(GList **input, const char **key, const pe_resource_t **rsc)
+{
+    pe_action_t *first = NULL;
+    pe_working_set_t *data_set = NULL;
+    const char *canonical = NULL;
+
+    *rsc = NULL;
+    if ((*input == NULL) || (*key == NULL)) {
+        return;
+    }
+
+    first = (pe_action_t *) (*input)->data;
+    if ((first->rsc == NULL) || (first->rsc->cluster == NULL)) {
+        return;
+    }
+
+    data_set = first->rsc->cluster;
+    canonical = pe__interned(data_set, *key);
+    if (canonical != NULL) {
+        *key = canonical;
+    }
+
+    if (data_set->action_index == NULL) {
+        return;
+    }
+
+    if (*input == first->rsc->actions) {
+        *rsc = first->rsc;
+
+    } else if (*input != data_set->actions) {
+        return; // Arbitrary list, which must be scanned
+    }
+
+    // Every action key is interned, so an unknown key can't match any action
+    *input = (canonical == NULL)? NULL
+             : g_hash_table_lookup(data_set->action_index, canonical);
+}
+
+/*!
+ * \internal
+ * \brief Check whether a string matches an (interned) action identifier
+ *
+ * \param[in] s   String to check
+ * \param[in] id  Action identifier to compare against
+ *
+ * \return true if \p s equals \p id, otherwise false
+ */
+static inline bool
+same_id(const char *s, const char *id)
+{
+    return (s == id) || safe_str_eq(s, id);
+}
+
 action_t *
 custom_action(resource_t * rsc, char *key, const char *task,
               node_t * on_node, gboolean optional, gboolean save_action,
@@ -508,15 +612,18 @@ custom_action(resource_t * rsc, char *key, const char *task,
     CRM_CHECK(key != NULL, return NULL);
     CRM_CHECK(task != NULL, free(key); return NULL);
 
-    if (save_action && rsc != NULL) {
-        possible_matches = find_actions(rsc->actions, key, on_node);
-    } else if(save_action) {
-#if 0
-        action = g_hash_table_lookup(data_set->singletons, key);
-#else
-        /* More expensive but takes 'node' into account */
-        possible_matches = find_actions(data_set->actions, key, on_node);
-#endif
+    if (save_action && (data_set->action_index != NULL)) {
+        const char *canonical = pe__interned(data_set, key);
+        GList *same_key = NULL;
+
+        if (canonical != NULL) {
+            same_key = g_hash_table_lookup(data_set->action_index, canonical);
+        }
+
+        /* Resource actions must belong to this resource, while actions
+         * without a resource may match any action with the same key.
+         */
+        possible_matches = find_matching_actions(same_key, rsc, key, on_node);
     }
 
     if(data_set->singletons == NULL) {
@@ -547,7 +654,9 @@ custom_action(resource_t * rsc, char *key, const char *task,
                          (on_node? on_node->details->uname : "no node"));
         }
 
-        action = calloc(1, sizeof(action_t));
+        action = pe__arena_alloc(pe__working_set_arena(data_set),
+                                 sizeof(action_t));
+        action->arena = data_set->arena;
         if (save_action) {
             action->id = data_set->action_id++;
         } else {
@@ -555,11 +664,11 @@ custom_action(resource_t * rsc, char *key, const char *task,
         }
         action->rsc = rsc;
         CRM_ASSERT(task != NULL);
-        action->task = strdup(task);
+        action->task = (char *) pe__intern(data_set, task);
         if (on_node) {
             action->node = node_copy(on_node);
         }
-        action->uuid = strdup(key);
+        action->uuid = (char *) pe__intern(data_set, key);
 
         if (safe_str_eq(task, CRM_OP_LRM_DELETE)) {
             // Resource history deletion for a node can be done on the DC
@@ -578,6 +687,7 @@ custom_action(resource_t * rsc, char *key, const char *task,
 
         if (save_action) {
             data_set->actions = g_list_prepend(data_set->actions, action);
+            index_action(action, data_set);
             if(rsc == NULL) {
                 g_hash_table_insert(data_set->singletons, action->uuid, action);
             }
@@ -1371,8 +1481,17 @@ pe_free_action(action_t * action)
     if (action == NULL) {
         return;
     }
-    g_list_free_full(action->actions_before, free);     /* action_wrapper_t* */
-    g_list_free_full(action->actions_after, free);      /* action_wrapper_t* */
+    if (action->arena != NULL) {
+        // Wrappers will be freed along with the rest of the arena
+        g_list_free(action->actions_before);
+        g_list_free(action->actions_after);
+    } else {
+        g_list_free_full(action->actions_before, free); // action_wrapper_t*
+        g_list_free_full(action->actions_after, free);  // action_wrapper_t*
+    }
+    if (action->after_index) {
+        g_hash_table_destroy(action->after_index);
+    }
     if (action->extra) {
         g_hash_table_destroy(action->extra);
     }
@@ -1386,10 +1505,230 @@ pe_free_action(action_t * action)
 #endif
     free(action->cancel_task);
     free(action->reason);
-    free(action->task);
-    free(action->uuid);
     free(action->node);
-    free(action);
+    if (action->arena == NULL) {
+        free(action->task);
+        free(action->uuid);
+        free(action);
+    }
+}
+
+/* Arena chunks are normally this size, though a larger allocation will get a
+ * chunk of its own
+ */
+#define ARENA_CHUNK_SIZE (64 * 1024)
+
+// Alignment suitable for any object allocated from an arena
+#define ARENA_ALIGN 16
+
+typedef struct pe__arena_chunk_s {
+    struct pe__arena_chunk_s *next;
+    size_t used;        // Bytes of data already handed out
+    size_t size;        // Bytes available in data
+    char data[];
+} pe__arena_chunk_t;
+
+struct pe__arena_s {
+    pe__arena_chunk_t *chunks;  // Most recently added chunk first
+    unsigned long long allocs;  // Number of allocations made
+    unsigned long long bytes;   // Number of bytes requested
+    unsigned long long capacity; // Number of bytes obtained via chunks
+};
+
+/*!
+ * \internal
+ * \brief Create a new arena
+ *
+ * An arena hands out memory with a simple bump pointer, and it is all released
+ * at once by pe__arena_free(). It is intended for the many small objects
+ * created during a scheduler run that live exactly as long as the working set.
+ *
+ * \return Newly allocated arena (guaranteed not to be NULL)
+ * \note The caller is responsible for freeing the result with
+ *       pe__arena_free().
+ */
+pe__arena_t *
+pe__arena_new(void)
+{
+    pe__arena_t *arena = calloc(1, sizeof(pe__arena_t));
+
+    CRM_ASSERT(arena != NULL);
+    return arena;
+}
+
+/*!
+ * \internal
+ * \brief Allocate zeroed memory from an arena
+ *
+ * \param[in,out] arena  Arena to allocate from (or NULL to use calloc())
+ * \param[in]     size   Number of bytes to allocate
+ *
+ * \return Newly allocated, zero-filled memory (guaranteed not to be NULL)
+ * \note Memory from an arena must not be passed to free(); it is released by
+ *       pe__arena_free(). If \p arena is NULL, the caller is responsible for
+ *       freeing the result with free() as usual.
+ */
+void *
+pe__arena_alloc(pe__arena_t *arena, size_t size)
+{
+    pe__arena_chunk_t *chunk = NULL;
+    uintptr_t start = 0;
+    size_t offset = 0;
+
+    if (arena == NULL) {
+        void *result = calloc(1, size);
+
+        CRM_ASSERT(result != NULL);
+        return result;
+    }
+
+    chunk = arena->chunks;
+    if (chunk != NULL) {
+        start = (uintptr_t) (chunk->data + chunk->used);
+        offset = chunk->used
+                 + ((ARENA_ALIGN - (start % ARENA_ALIGN)) % ARENA_ALIGN);
+    }
+
+    if ((chunk == NULL) || (offset + size > chunk->size)) {
+        size_t chunk_size = QB_MAX(ARENA_CHUNK_SIZE, size + ARENA_ALIGN);
+
+        // calloc() memory is already zeroed, and is never reused
+        chunk = calloc(1, sizeof(pe__arena_chunk_t) + chunk_size);
+        CRM_ASSERT(chunk != NULL);
+        chunk->size = chunk_size;
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->capacity += chunk_size;
+
+        start = (uintptr_t) chunk->data;
+        offset = (ARENA_ALIGN - (start % ARENA_ALIGN)) % ARENA_ALIGN;
+    }
+
+    chunk->used = offset + size;
+    arena->allocs++;
+    arena->bytes += size;
+    return chunk->data + offset;
+}
+
+/*!
+ * \internal
+ * \brief Free an arena and everything allocated from it
+ *
+ * \param[in] arena  Arena to free
+ */
+void
+pe__arena_free(pe__arena_t *arena)
+{
+    if (arena == NULL) {
+        return;
+    }
+    crm_trace("Freeing arena: %llu allocations totaling %llu bytes "
+              "(%llu bytes reserved)",
+              arena->allocs, arena->bytes, arena->capacity);
+    while (arena->chunks != NULL) {
+        pe__arena_chunk_t *next = arena->chunks->next;
+
+        free(arena->chunks);
+        arena->chunks = next;
+    }
+    free(arena);
+}
+
+/*!
+ * \internal
+ * \brief Get allocation statistics for an arena
+ *
+ * \param[in]  arena   Arena to check
+ * \param[out] allocs  Where to store number of allocations made from arena
+ * \param[out] bytes   Where to store total number of bytes allocated
+ */
+void
+pe__arena_stats(const pe__arena_t *arena, unsigned long long *allocs,
+                unsigned long long *bytes)
+{
+    if (allocs != NULL) {
+        *allocs = (arena == NULL)? 0 : arena->allocs;
+    }
+    if (bytes != NULL) {
+        *bytes = (arena == NULL)? 0 : arena->bytes;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Get a working set's arena, creating it if needed
+ *
+ * \param[in,out] data_set  Working set to check
+ *
+ * \return Arena that is freed along with \p data_set's calculations
+ */
+pe__arena_t *
+pe__working_set_arena(pe_working_set_t *data_set)
+{
+    if (data_set->arena == NULL) {
+        data_set->arena = pe__arena_new();
+    }
+    return data_set->arena;
+}
+
+/*!
+ * \internal
+ * \brief Get the canonical copy of a string in a working set
+ *
+ * Identifiers such as action keys and names are repeated many times in a
+ * scheduler run. Interning them keeps a single copy of each, and lets code
+ * that has a canonical copy compare strings by address.
+ *
+ * \param[in,out] data_set  Working set to intern string in
+ * \param[in]     s         String to intern
+ *
+ * \return Canonical copy of \p s (or NULL if \p s is NULL)
+ * \note The result is valid until the working set is reset, and must not be
+ *       modified or freed by the caller.
+ */
+const char *
+pe__intern(pe_working_set_t *data_set, const char *s)
+{
+    char *canonical = NULL;
+
+    if (s == NULL) {
+        return NULL;
+    }
+    if (data_set->interned == NULL) {
+        data_set->interned = g_hash_table_new(crm_str_hash, g_str_equal);
+    } else {
+        canonical = g_hash_table_lookup(data_set->interned, s);
+        if (canonical != NULL) {
+            return canonical;
+        }
+    }
+
+    canonical = pe__arena_alloc(pe__working_set_arena(data_set),
+                                strlen(s) + 1);
+    strcpy(canonical, s);
+    g_hash_table_add(data_set->interned, canonical);
+    return canonical;
+}
+
+/*!
+ * \internal
+ * \brief Get the canonical copy of a string in a working set, if any
+ *
+ * \param[in] data_set  Working set to check
+ * \param[in] s         String to look up
+ *
+ * \return Canonical copy of \p s if it has been interned, otherwise NULL
+ * \note This hashes \p s, so callers that already have a canonical copy
+ *       should use it directly (for example, as a key in a table that uses
+ *       direct hashing) rather than looking it up again.
+ */
+const char *
+pe__interned(const pe_working_set_t *data_set, const char *s)
+{
+    if ((s == NULL) || (data_set->interned == NULL)) {
+        return NULL;
+    }
+    return g_hash_table_lookup(data_set->interned, s);
 }
 
 GListPtr
@@ -1454,16 +1793,22 @@ action_t *
 find_first_action(GListPtr input, const char *uuid, const char *task, node_t * on_node)
 {
     GListPtr gIter = NULL;
+    const pe_resource_t *rsc = NULL;
 
     CRM_CHECK(uuid || task, return NULL);
 
+    narrow_to_index(&input, &uuid, &rsc);
+
     for (gIter = input; gIter != NULL; gIter = gIter->next) {
         action_t *action = (action_t *) gIter->data;
 
-        if (uuid != NULL && safe_str_neq(uuid, action->uuid)) {
+        if ((rsc != NULL) && (action->rsc != rsc)) {
+            continue;
+
+        } else if (uuid != NULL && !same_id(uuid, action->uuid)) {
             continue;
 
-        } else if (task != NULL && safe_str_neq(task, action->task)) {
+        } else if (task != NULL && !same_id(task, action->task)) {
             continue;
 
         } else if (on_node == NULL) {
@@ -1480,18 +1825,32 @@ find_first_action(GListPtr input, const char *uuid, const char *task, node_t * o
     return NULL;
 }
 
-GListPtr
-find_actions(GListPtr input, const char *key, const node_t *on_node)
+/*!
+ * \internal
+ * \brief Find actions in a list that match a key and (if given) a node
+ *
+ * \param[in] input    List of actions to search
+ * \param[in] rsc      If not NULL, only actions for this resource may match
+ * \param[in] key      Action key to match
+ * \param[in] on_node  If not NULL, only actions on this node may match
+ *
+ * \return List of matching actions (or NULL if none)
+ * \note Matching actions without a node will be assigned to \p on_node.
+ */
+static GList *
+find_matching_actions(GList *input, const pe_resource_t *rsc, const char *key,
+                      const pe_node_t *on_node)
 {
     GListPtr gIter = input;
     GListPtr result = NULL;
 
-    CRM_CHECK(key != NULL, return NULL);
-
     for (; gIter != NULL; gIter = gIter->next) {
         action_t *action = (action_t *) gIter->data;
 
-        if (safe_str_neq(key, action->uuid)) {
+        if ((rsc != NULL) && (action->rsc != rsc)) {
+            continue;
+
+        } else if (!same_id(key, action->uuid)) {
             crm_trace("%s does not match action %s", key, action->uuid);
             continue;
 
@@ -1520,10 +1879,22 @@ find_actions(GListPtr input, const char *key, const node_t *on_node)
     return result;
 }
 
+GListPtr
+find_actions(GListPtr input, const char *key, const node_t *on_node)
+{
+    const pe_resource_t *rsc = NULL;
+
+    CRM_CHECK(key != NULL, return NULL);
+
+    narrow_to_index(&input, &key, &rsc);
+    return find_matching_actions(input, rsc, key, on_node);
+}
+
 GList *
 find_actions_exact(GList *input, const char *key, const pe_node_t *on_node)
 {
     GList *result = NULL;
+    const pe_resource_t *rsc = NULL;
 
     CRM_CHECK(key != NULL, return NULL);
 
@@ -1533,14 +1904,19 @@ find_actions_exact(GList *input, const char *key, const pe_node_t *on_node)
         return NULL;
     }
 
+    narrow_to_index(&input, &key, &rsc);
+
     for (GList *gIter = input; gIter != NULL; gIter = gIter->next) {
         pe_action_t *action = (pe_action_t *) gIter->data;
 
-        if (action->node == NULL) {
+        if ((rsc != NULL) && (action->rsc != rsc)) {
+            continue;
+
+        } else if (action->node == NULL) {
             crm_trace("Skipping comparison of %s vs action %s without node",
                       key, action->uuid);
 
-        } else if (safe_str_neq(key, action->uuid)) {
+        } else if (!same_id(key, action->uuid)) {
             crm_trace("Desired action %s doesn't match %s", key, action->uuid);
 
         } else if (safe_str_neq(on_node->details->id,
@@ -1829,6 +2205,48 @@ get_target_role(resource_t * rsc, enum rsc_role_e * role)
     return TRUE;
 }
 
+/* Index an action's "after" orderings by action once there are this many,
+ * so duplicate checks in order_actions() don't become quadratic for actions
+ * with many orderings (such as clone notifications and ordering sets)
+ */
+#define AFTER_INDEX_THRESHOLD 16
+
+/*!
+ * \internal
+ * \brief Add an action's newest "after" ordering to its index if appropriate
+ *
+ * \param[in,out] action   Action whose actions_after was just prepended to
+ * \param[in]     wrapper  Wrapper that was prepended
+ */
+static void
+index_after_wrapper(pe_action_t *action, pe_action_wrapper_t *wrapper)
+{
+    GList *same_action = NULL;
+
+    if (action->after_index == NULL) {
+        if (g_list_length(action->actions_after) < AFTER_INDEX_THRESHOLD) {
+            return;
+        }
+        action->after_index = g_hash_table_new_full(g_direct_hash,
+                                                    g_direct_equal, NULL,
+                                                    (GDestroyNotify) g_list_free);
+
+        // Index every existing wrapper, including the new one
+        for (GList *iter = action->actions_after; iter != NULL;
+             iter = iter->next) {
+            index_after_wrapper(action, (pe_action_wrapper_t *) iter->data);
+        }
+        return;
+    }
+
+    same_action = g_hash_table_lookup(action->after_index, wrapper->action);
+    if (same_action != NULL) {
+        g_hash_table_steal(action->after_index, wrapper->action);
+    }
+    g_hash_table_insert(action->after_index, wrapper->action,
+                        g_list_prepend(same_action, wrapper));
+}
+
 gboolean
 order_actions(action_t * lh_action, action_t * rh_action, enum pe_ordering order)
 {
@@ -1849,8 +2267,13 @@ order_actions(action_t * lh_action, action_t * rh_action, enum pe_ordering order
     /* Ensure we never create a dependency on ourselves... it's happened */
     CRM_ASSERT(lh_action != rh_action);
 
-    /* Filter dups, otherwise update_action_states() has too much work to do */
+    /* Filter dups, otherwise update_action_states() has too much work to do.
+     * Only orderings with rh_action need to be checked, if they're indexed.
+     */
     gIter = lh_action->actions_after;
+    if (lh_action->after_index != NULL) {
+        gIter = g_hash_table_lookup(lh_action->after_index, rh_action);
+    }
     for (; gIter != NULL; gIter = gIter->next) {
         action_wrapper_t *after = (action_wrapper_t *) gIter->data;
 
@@ -1859,20 +2282,21 @@ order_actions(action_t * lh_action, action_t * rh_action, enum pe_ordering order
         }
     }
 
-    wrapper = calloc(1, sizeof(action_wrapper_t));
+    wrapper = pe__arena_alloc(lh_action->arena, sizeof(action_wrapper_t));
     wrapper->action = rh_action;
     wrapper->type = order;
 
     list = lh_action->actions_after;
     list = g_list_prepend(list, wrapper);
     lh_action->actions_after = list;
+    index_after_wrapper(lh_action, wrapper);
 
     wrapper = NULL;
 
 /* 	order |= pe_order_implies_then; */
 /* 	order ^= pe_order_implies_then; */
 
-    wrapper = calloc(1, sizeof(action_wrapper_t));
+    wrapper = pe__arena_alloc(rh_action->arena, sizeof(action_wrapper_t));
     wrapper->action = lh_action;
     wrapper->type = order;
     list = rh_action->actions_before;
@@ -207,6 +207,7 @@ resources_action_create(const char *name, const char *standard,
 
     op = calloc(1, sizeof(svc_action_t));
     op->opaque = calloc(1, sizeof(svc_action_private_t));
+    op->opaque->output_max = services__default_output_max();
     op->rsc = strdup(name);
     op->interval_ms = interval_ms;
     op->timeout = timeout;
@@ -312,6 +313,7 @@ services_action_create_generic(const char *exec, const char *args[])
 
     op = calloc(1, sizeof(*op));
     op->opaque = calloc(1, sizeof(svc_action_private_t));
+    op->opaque->output_max = services__default_output_max();
 
     op->opaque->exec = strdup(exec);
     op->opaque->args[0] = strdup(exec);
@@ -379,6 +381,53 @@ services_action_user(svc_action_t *op, const char *user)
     return crm_user_lookup(user, &(op->opaque->uid), &(op->opaque->gid));
 }
 
+/*!
+ * \internal
+ * \brief Get the default cap on captured agent output
+ *
+ * \return Value of PCMK_agent_output_max in bytes (or 0 for no cap)
+ */
+size_t
+services__default_output_max(void)
+{
+    static bool initialized = false;
+    static size_t output_max = 0;
+
+    if (!initialized) {
+        const char *value = pcmk__env_option("agent_output_max");
+
+        if (value != NULL) {
+            long long max = crm_parse_ll(value, NULL);
+
+            if (max > 0) {
+                output_max = (size_t) max;
+            } else if (max < 0) {
+                crm_warn("Ignoring invalid value '%s' for PCMK_agent_output_max",
+                         value);
+            }
+        }
+        initialized = true;
+    }
+    return output_max;
+}
+
+/*!
+ * \brief Limit how much of an action's stdout and stderr will be kept
+ *
+ * \param[in,out] op         Action to modify
+ * \param[in]     max_bytes  Maximum bytes to keep of each stream (0 for no cap)
+ *
+ * \note If an agent produces more output than this, the beginning and end of
+ *       the output are kept, and a note about the omitted bytes is inserted
+ *       between them. The default comes from PCMK_agent_output_max.
+ */
+void
+services_action_set_output_max(svc_action_t *op, size_t max_bytes)
+{
+    CRM_CHECK((op != NULL) && (op->opaque != NULL), return);
+    op->opaque->output_max = max_bytes;
+}
+
 /*!
  * \brief Execute an alert agent action
  *
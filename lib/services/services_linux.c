@@ -252,41 +252,182 @@ close_pipe(int fildes[])
     }
 }
 
-static gboolean
-svc_read_output(int fd, svc_action_t * op, bool is_stderr)
+/* Minimum free space to have in an output buffer before each read. Buffers
+ * grow geometrically, so later reads can drain a full pipe in one call.
+ */
+#define SVC_OUTPUT_READ_MIN 4096
+
+/* Maximum output to read in one main loop dispatch, so an agent producing a
+ * continuous stream of output can't starve other sources
+ */
+#define SVC_OUTPUT_DISPATCH_MAX (1024 * 1024)
+
+/*!
+ * \internal
+ * \brief Get the capture state for one of an action's output streams
+ *
+ * \param[in,out] op         Action to check
+ * \param[in]     is_stderr  Whether to get stderr (rather than stdout) state
+ * \param[out]    data       Where to store location of action's output string
+ *
+ * \return Capture state for requested stream
+ */
+static svc_output_t *
+op_output(svc_action_t *op, bool is_stderr, char ***data)
 {
-    char *data = NULL;
-    int rc = 0, len = 0;
-    char buf[500];
-    static const size_t buf_read_len = sizeof(buf) - 1;
+    svc_output_t *out = NULL;
 
+    if (is_stderr) {
+        out = &(op->opaque->stderr_buf);
+        *data = &(op->stderr_data);
+    } else {
+        out = &(op->opaque->stdout_buf);
+        *data = &(op->stdout_data);
+    }
 
-    if (fd < 0) {
-        crm_trace("No fd for %s", op->id);
-        return FALSE;
+    /* Callers may free, take, or replace the output string between reads, so
+     * fall back to measuring it if it's not the buffer we last filled.
+     */
+    if (**data != out->data) {
+        out->data = **data;
+        out->len = (out->data == NULL)? 0 : strlen(out->data);
+        out->size = (out->data == NULL)? 0 : (out->len + 1);
+        out->omitted = 0;
     }
+    return out;
+}
 
-    if (is_stderr && op->stderr_data) {
-        len = strlen(op->stderr_data);
-        data = op->stderr_data;
-        crm_trace("Reading %s stderr into offset %d", op->id, len);
+/*!
+ * \internal
+ * \brief Make room in an output buffer for another read
+ *
+ * \param[in,out] out  Capture state for output stream
+ * \param[in]     max  If nonzero, maximum number of bytes to keep
+ *
+ * \return Number of bytes that may be read into buffer
+ */
+static size_t
+reserve_output(svc_output_t *out, size_t max)
+{
+    size_t limit = 0;
+    size_t wanted = out->len + SVC_OUTPUT_READ_MIN + 1;
 
-    } else if (is_stderr == FALSE && op->stdout_data) {
-        len = strlen(op->stdout_data);
-        data = op->stdout_data;
-        crm_trace("Reading %s stdout into offset %d", op->id, len);
+    if (max > 0) {
+        /* Let the buffer grow to twice the cap before discarding anything.
+         * Then keep the first half of the cap and slide the most recent output
+         * down after it, so each byte is moved at most once on average.
+         */
+        limit = 2 * max + SVC_OUTPUT_READ_MIN + 1;
+        if (wanted > limit) {
+            size_t head = max / 2;
+            size_t tail = max - head;
+
+            memmove(out->data + head, out->data + out->len - tail, tail);
+            out->omitted += out->len - max;
+            out->len = max;
+            wanted = out->len + SVC_OUTPUT_READ_MIN + 1;
+        }
+    }
 
-    } else {
-        crm_trace("Reading %s %s into offset %d", op->id, is_stderr?"stderr":"stdout", len);
+    if (wanted > out->size) {
+        size_t size = QB_MAX(2 * out->size, wanted);
+
+        if ((limit > 0) && (size > limit)) {
+            size = limit;
+        }
+        out->data = realloc_safe(out->data, size);
+        out->size = size;
+    }
+    return out->size - out->len - 1;
+}
+
+/*!
+ * \internal
+ * \brief Replace discarded output with a note once capture is complete
+ *
+ * \param[in,out] op         Action whose output has been read
+ * \param[in]     is_stderr  Whether to finish stderr (rather than stdout)
+ */
+static void
+finish_capped_output(svc_action_t *op, bool is_stderr)
+{
+    char **data = NULL;
+    svc_output_t *out = op_output(op, is_stderr, &data);
+    size_t max = op->opaque->output_max;
+    size_t head = max / 2;
+    size_t tail = max - head;
+    char *note = NULL;
+    char *capped = NULL;
+    size_t note_len = 0;
+
+    if ((max == 0) || (out->len <= max)) {
+        return;
     }
 
+    out->omitted += out->len - max;
+    note = crm_strdup_printf("\n... [%llu bytes of output omitted] ...\n",
+                             (unsigned long long) out->omitted);
+    note_len = strlen(note);
+
+    capped = malloc(max + note_len + 1);
+    CRM_ASSERT(capped != NULL);
+    memcpy(capped, out->data, head);
+    memcpy(capped + head, note, note_len);
+    memcpy(capped + head + note_len, out->data + out->len - tail, tail);
+    capped[max + note_len] = '\0';
+
+    crm_notice("Discarded %llu bytes of %s[%d] %s over the %llu-byte limit",
+               (unsigned long long) out->omitted, op->id, op->pid,
+               (is_stderr? "stderr" : "stdout"), (unsigned long long) max);
+
+    free(note);
+    free(out->data);
+    out->data = *data = capped;
+    out->len = max + note_len;
+    out->size = out->len + 1;
+}
+
+/*!
+ * \internal
+ * \brief Read available output from an action's stdout or stderr pipe
+ *
+ * \param[in]     fd         Pipe to read from
+ * \param[in,out] op         Action to read output for
+ * \param[in]     is_stderr  Whether \p fd is stderr (rather than stdout)
+ * \param[in]     drain      If false, stop after SVC_OUTPUT_DISPATCH_MAX bytes
+ *
+ * \return FALSE on EOF or error, otherwise TRUE
+ */
+static gboolean
+svc_read_output(int fd, svc_action_t * op, bool is_stderr, bool drain)
+{
+    char **data = NULL;
+    svc_output_t *out = NULL;
+    ssize_t rc = 0;
+    size_t available = 0;
+    size_t total = 0;
+
+    if (fd < 0) {
+        crm_trace("No fd for %s", op->id);
+        return FALSE;
+    }
+
+    out = op_output(op, is_stderr, &data);
+    crm_trace("Reading %s %s into offset %llu", op->id,
+              (is_stderr? "stderr" : "stdout"), (unsigned long long) out->len);
+
     do {
-        rc = read(fd, buf, buf_read_len);
+        available = reserve_output(out, op->opaque->output_max);
+        rc = read(fd, out->data + out->len, available);
         if (rc > 0) {
-            buf[rc] = 0;
-            crm_trace("Got %d chars: %.80s", rc, buf);
-            data = realloc_safe(data, len + rc + 1);
-            len += sprintf(data + len, "%s", buf);
+            crm_trace("Got %lld chars: %.80s",
+                      (long long) rc, out->data + out->len);
+            out->len += rc;
+            out->data[out->len] = '\0';
+            total += rc;
+            if (!drain && (total >= SVC_OUTPUT_DISPATCH_MAX)) {
+                break;  // The rest will be read at the next dispatch
+            }
 
         } else if (errno != EINTR) {
             /* error or EOF
@@ -296,15 +437,18 @@ svc_read_output(int fd, svc_action_t * op, bool is_stderr)
             break;
         }
 
-    } while (rc == buf_read_len || rc < 0);
+    } while ((rc == (ssize_t) available) || (rc < 0));
 
-    if (is_stderr) {
-        op->stderr_data = data;
-    } else {
-        op->stdout_data = data;
+    /* Actions without output keep a NULL string, because callers check for
+     * that to decide which output to use
+     */
+    if (out->len == 0) {
+        free(out->data);
+        out->data = NULL;
+        out->size = 0;
     }
-
-    return rc;
+    *data = out->data;
+    return (rc != 0);
 }
 
 static int
@@ -312,7 +456,7 @@ dispatch_stdout(gpointer userdata)
 {
     svc_action_t *op = (svc_action_t *) userdata;
 
-    return svc_read_output(op->opaque->stdout_fd, op, FALSE);
+    return svc_read_output(op->opaque->stdout_fd, op, FALSE, false);
 }
 
 static int
@@ -320,7 +464,7 @@ dispatch_stderr(gpointer userdata)
 {
     svc_action_t *op = (svc_action_t *) userdata;
 
-    return svc_read_output(op->opaque->stderr_fd, op, TRUE);
+    return svc_read_output(op->opaque->stderr_fd, op, TRUE, false);
 }
 
 static void
@@ -553,7 +697,7 @@ finish_op_output(svc_action_t *op, bool is_stderr)
     if (op->synchronous || *source) {
         crm_trace("Finish reading %s[%d] %s",
                   op->id, op->pid, (is_stderr? "stdout" : "stderr"));
-        svc_read_output(fd, op, is_stderr);
+        svc_read_output(fd, op, is_stderr, true);
         if (op->synchronous) {
             close(fd);
         } else {
@@ -561,6 +705,7 @@ finish_op_output(svc_action_t *op, bool is_stderr)
             *source = NULL;
         }
     }
+    finish_capped_output(op, is_stderr);
 }
 
 // Log an operation's stdout and stderr
@@ -788,11 +933,11 @@ action_synced_wait(svc_action_t *op, struct sigchld_data_s *data)
 
         if (poll_rc > 0) {
             if (fds[0].revents & POLLIN) {
-                svc_read_output(op->opaque->stdout_fd, op, FALSE);
+                svc_read_output(op->opaque->stdout_fd, op, FALSE, false);
             }
 
             if (fds[1].revents & POLLIN) {
-                svc_read_output(op->opaque->stderr_fd, op, TRUE);
+                svc_read_output(op->opaque->stderr_fd, op, TRUE, false);
             }
 
             if ((fds[2].revents & POLLIN) && sigchld_received(fds[2].fd)) {
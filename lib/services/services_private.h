@@ -16,6 +16,15 @@
 #endif
 
 #define MAX_ARGC        255
+
+// Output captured from an action's stdout or stderr pipe
+typedef struct svc_output_s {
+    char *data;         // Buffer last stored in the action (to detect changes)
+    size_t len;         // Number of bytes currently in buffer
+    size_t size;        // Allocated size of buffer
+    size_t omitted;     // Bytes discarded between head and tail due to cap
+} svc_output_t;
+
 struct svc_action_private_s {
     char *exec;
     char *args[MAX_ARGC];
@@ -34,12 +43,19 @@ struct svc_action_private_s {
     mainloop_io_t *stdout_gsource;
 
     int stdin_fd;
+
+    size_t output_max;  // If nonzero, keep at most this much of each stream
+    svc_output_t stdout_buf;
+    svc_output_t stderr_buf;
 #if SUPPORT_DBUS
     DBusPendingCall* pending;
     unsigned timerid;
 #endif
 };
 
+G_GNUC_INTERNAL
+size_t services__default_output_max(void);
+
 G_GNUC_INTERNAL
 GList *services_os_get_directory_list(const char *root, gboolean files, gboolean executable);
 
@@ -53,7 +53,7 @@ mock_based_cib_notify_send_one(pcmk__client_t *client, xmlNode *xml)
     };
 
     CRM_CHECK(client != NULL, return true);
-    pcmk__ipc_prepare_iov(0, xml, 0, &iov, &bytes);
+    pcmk__ipc_prepare_iov(0, xml, 0, pcmk__codec_bzip2, &iov, &bytes);
     update.iov = iov;
     update.iov_size = bytes;
     if (client->ipcs == NULL && client->remote == NULL) {
@@ -84,6 +84,21 @@ const char *print_neg_location_prefix = "";
 static time_t last_refresh = 0;
 crm_trigger_t *refresh_trigger = NULL;
 
+/* Whether anything outside the status section may have changed since the
+ * last refresh (status-only changes are coalesced more aggressively)
+ */
+static gboolean config_changed = TRUE;
+
+/* Whether something happened since the last refresh (a fencing event or a
+ * failed operation) that should be displayed without any coalescing
+ */
+static gboolean urgent_refresh = FALSE;
+
+/* Status-only changes are coalesced into at most one refresh this often
+ * (in seconds), regardless of the reconnect interval
+ */
+#define MON_STATUS_REFRESH_S 2
+
 static pcmk__supported_format_t formats[] = {
 #if CURSES_ENABLED
     CRM_MON_SUPPORTED_FORMAT_CURSES,
@@ -1593,6 +1608,155 @@ crm_diff_update_v1(const char *event, xmlNode * msg)
     freeXpathObject(xpathObj);
 }
 
+/*!
+ * \internal
+ * \brief Check whether a CIB patchset changes only the status section
+ *
+ * \param[in] diff  Patchset to check
+ *
+ * \return TRUE if \p diff is a v2 patchset that changes only the status
+ *         section (and CIB version or bookkeeping attributes), otherwise FALSE
+ */
+#define STATUS_PATH "/" XML_TAG_CIB "/" XML_CIB_TAG_STATUS
+
+static gboolean
+status_only_patchset(xmlNode *diff)
+{
+    static const char *bookkeeping[] = {
+        XML_ATTR_NUMUPDATES, XML_ATTR_GENERATION, XML_CIB_ATTR_WRITTEN,
+        XML_ATTR_UPDATE_ORIG, XML_ATTR_UPDATE_CLIENT, XML_ATTR_UPDATE_USER,
+        XML_ATTR_HAVE_QUORUM, XML_ATTR_DC_UUID
+    };
+    int format = 1;
+    xmlNode *change = NULL;
+
+    crm_element_value_int(diff, "format", &format);
+    if (format != 2) {
+        return FALSE; // Not worth parsing the older format
+    }
+
+    for (change = __xml_first_child_element(diff); change != NULL;
+         change = __xml_next_element(change)) {
+
+        const char *op = crm_element_value(change, XML_DIFF_OP);
+        const char *xpath = crm_element_value(change, XML_DIFF_PATH);
+
+        if ((op == NULL) || (xpath == NULL)) {
+            continue; // Version information
+
+        } else if (crm_starts_with(xpath, STATUS_PATH)
+                   && ((xpath[strlen(STATUS_PATH)] == '\0')
+                       || (xpath[strlen(STATUS_PATH)] == '/'))) {
+            continue;
+
+        } else if (safe_str_eq(xpath, "/" XML_TAG_CIB)
+                   && safe_str_eq(op, "modify")) {
+            xmlNode *attr = NULL;
+
+            for (attr = first_named_child(first_named_child(change,
+                                                            XML_DIFF_LIST),
+                                          XML_DIFF_ATTR);
+                 attr != NULL; attr = crm_next_same_xml(attr)) {
+
+                const char *name = crm_element_value(attr,
+                                                     XML_NVPAIR_ATTR_NAME);
+                int lpc = 0;
+
+                for (lpc = 0; lpc < DIMOF(bookkeeping); lpc++) {
+                    if (safe_str_eq(name, bookkeeping[lpc])) {
+                        break;
+                    }
+                }
+                if (lpc == DIMOF(bookkeeping)) {
+                    return FALSE;
+                }
+            }
+
+        } else {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*!
+ * \internal
+ * \brief Check whether XML contains a failed resource operation
+ *
+ * \param[in] xml  XML to search (an operation history entry or its ancestor)
+ *
+ * \return TRUE if \p xml is or contains a failed operation, otherwise FALSE
+ */
+static gboolean
+has_failed_op(xmlNode *xml)
+{
+    xmlNode *child = NULL;
+
+    if (safe_str_eq((const char *) xml->name, XML_LRM_TAG_RSC_OP)) {
+        int rc = -1;
+        int status = -1;
+        int target_rc = -1;
+        const char *magic = crm_element_value(xml, XML_ATTR_TRANSITION_MAGIC);
+
+        if ((magic == NULL)
+            || !decode_transition_magic(magic, NULL, NULL, NULL, &status, &rc,
+                                        &target_rc)) {
+            return FALSE;
+        }
+        if (status == PCMK_LRM_OP_DONE) {
+            return (rc != target_rc);
+        }
+        return (status != PCMK_LRM_OP_PENDING);
+    }
+
+    for (child = __xml_first_child_element(xml); child != NULL;
+         child = __xml_next_element(child)) {
+        if (has_failed_op(child)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*!
+ * \internal
+ * \brief Check whether a CIB patchset records a failed resource operation
+ *
+ * \param[in] diff  Patchset to check
+ *
+ * \return TRUE if \p diff is a v2 patchset that creates or modifies a failed
+ *         operation history entry, otherwise FALSE
+ */
+static gboolean
+patchset_has_failed_op(xmlNode *diff)
+{
+    int format = 1;
+    xmlNode *change = NULL;
+
+    crm_element_value_int(diff, "format", &format);
+    if (format != 2) {
+        return FALSE;
+    }
+
+    for (change = __xml_first_child_element(diff); change != NULL;
+         change = __xml_next_element(change)) {
+
+        const char *op = crm_element_value(change, XML_DIFF_OP);
+        xmlNode *result = NULL;
+
+        if (safe_str_eq(op, "create")) {
+            result = __xml_first_child_element(change);
+
+        } else if (safe_str_eq(op, "modify")) {
+            result = first_named_child(change, XML_DIFF_RESULT);
+        }
+        if ((result != NULL) && has_failed_op(result)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 static void
 crm_diff_update(const char *event, xmlNode * msg)
 {
@@ -1603,6 +1767,13 @@ crm_diff_update(const char *event, xmlNode * msg)
 
     print_dot(output_format);
 
+    if (!status_only_patchset(diff)) {
+        config_changed = TRUE;
+    }
+    if (patchset_has_failed_op(diff)) {
+        urgent_refresh = TRUE;
+    }
+
     if (current_cib != NULL) {
         rc = xml_apply_patchset(current_cib, diff, TRUE);
 
@@ -1623,6 +1794,7 @@ crm_diff_update(const char *event, xmlNode * msg)
 
     if (current_cib == NULL) {
         crm_trace("Re-requesting the full cib");
+        config_changed = TRUE;
         cib->cmds->query(cib, NULL, &current_cib, cib_scope_local | cib_sync_call);
     }
 
@@ -1660,6 +1832,8 @@ mon_refresh_display(gpointer user_data)
     stonith_history_t *stonith_history = NULL;
 
     last_refresh = time(NULL);
+    config_changed = FALSE;
+    urgent_refresh = FALSE;
 
     if (cli_config_update(&cib_copy, NULL, FALSE) == FALSE) {
         if (cib) {
@@ -1800,15 +1974,33 @@ kick_refresh(gboolean data_updated)
 
     /* Refresh
      * - immediately if the last update was more than 5s ago
-     * - every 10 cib-updates
+     * - immediately after a fencing event or failed operation
+     * - every 10 cib-updates, if the configuration may have changed
+     * - every MON_STATUS_REFRESH_S seconds, if only the status has changed
      * - at most 2s after the last update
+     *
+     * A busy cluster can produce a steady stream of status-only updates, and
+     * each refresh rebuilds the entire cluster status. Those updates therefore
+     * don't count towards the 10 updates, and are instead coalesced into one
+     * refresh every MON_STATUS_REFRESH_S seconds while the stream continues.
      */
     if ((now - last_refresh) > (options.reconnect_msec / 1000)) {
         mainloop_set_trigger(refresh_trigger);
         mainloop_timer_stop(refresh_timer);
         updates = 0;
 
-    } else if(updates >= 10) {
+    } else if (urgent_refresh) {
+        mainloop_set_trigger(refresh_trigger);
+        mainloop_timer_stop(refresh_timer);
+        updates = 0;
+
+    } else if (!config_changed
+               && ((now - last_refresh) >= MON_STATUS_REFRESH_S)) {
+        mainloop_set_trigger(refresh_trigger);
+        mainloop_timer_stop(refresh_timer);
+        updates = 0;
+
+    } else if ((updates >= 10) && config_changed) {
         mainloop_set_trigger(refresh_trigger);
         mainloop_timer_stop(refresh_timer);
         updates = 0;
@@ -1826,6 +2018,7 @@ mon_st_callback_display(stonith_t * st, stonith_event_t * e)
         mon_cib_connection_destroy(NULL);
     } else {
         print_dot(output_format);
+        urgent_refresh = TRUE;
         kick_refresh(TRUE);
     }
 }
@@ -1141,6 +1141,126 @@ update_working_set_xml(pe_working_set_t *data_set, xmlNode **xml)
     return pcmk_ok;
 }
 
+/* When polling (because CIB change notifications are unavailable), how long
+ * to sleep between cluster state checks
+ */
+#define WAIT_SLEEP_S (2)
+
+/* When waiting for CIB changes, recheck cluster state at least this often,
+ * in case something time-based has changed
+ */
+#define WAIT_RECHECK_S (30)
+
+/* While waiting for cluster activity, the CIB is watched for changes, and a
+ * local copy of it is kept current by applying each change notification, so
+ * that cluster state is rechecked only when something has changed, without
+ * querying the CIB manager for the full CIB each time.
+ */
+static cib_t *watched_cib = NULL;
+static xmlNode *watched_xml = NULL;
+static bool watched_xml_usable = FALSE; // local copy may be used for next check
+static bool cib_changed = FALSE;
+
+static void
+watched_cib_updated(const char *event, xmlNode *msg)
+{
+    int rc = -pcmk_err_diff_failed;
+    xmlNode *diff = get_message_xml(msg, F_CIB_UPDATE_RESULT);
+
+    if (watched_xml != NULL) {
+        rc = xml_apply_patchset(watched_xml, diff, TRUE);
+        if (rc != pcmk_ok) {
+            crm_debug("Discarding local CIB copy: %s " CRM_XS " rc=%d",
+                      pcmk_strerror(rc), rc);
+            free_xml(watched_xml);
+            watched_xml = NULL;
+        }
+    }
+    cib_changed = TRUE;
+}
+
+/*!
+ * \internal
+ * \brief Subscribe to CIB change notifications while waiting
+ *
+ * \param[in] cib  Connection to the CIB manager
+ *
+ * \note If notifications are unavailable (for example, with a file-based CIB),
+ *       waits will fall back to polling.
+ */
+static void
+watch_cib(cib_t *cib)
+{
+    int rc = cib->cmds->add_notify_callback(cib, T_CIB_DIFF_NOTIFY,
+                                            watched_cib_updated);
+
+    if (rc != pcmk_ok) {
+        crm_debug("Polling for CIB changes because notifications are "
+                  "unavailable: %s " CRM_XS " rc=%d", pcmk_strerror(rc), rc);
+        return;
+    }
+    watched_cib = cib;
+}
+
+static void
+unwatch_cib(void)
+{
+    if (watched_cib != NULL) {
+        watched_cib->cmds->del_notify_callback(watched_cib, T_CIB_DIFF_NOTIFY,
+                                               watched_cib_updated);
+        watched_cib = NULL;
+    }
+    free_xml(watched_xml);
+    watched_xml = NULL;
+    watched_xml_usable = FALSE;
+}
+
+static gboolean
+wait_expired(gpointer user_data)
+{
+    bool *expired = user_data;
+
+    *expired = TRUE;
+    return FALSE;
+}
+
+/*!
+ * \internal
+ * \brief Wait until the CIB changes or a timeout is reached
+ *
+ * \param[in] timeout_s  Maximum number of seconds to wait
+ */
+static void
+wait_for_cib_change(int timeout_s)
+{
+    bool expired = FALSE;
+    guint timer = 0;
+
+    if (timeout_s <= 0) {
+        return;
+    }
+    if (watched_cib == NULL) {
+        sleep(QB_MIN(timeout_s, WAIT_SLEEP_S));
+        return;
+    }
+
+    timer = g_timeout_add_seconds(QB_MIN(timeout_s, WAIT_RECHECK_S),
+                                  wait_expired, &expired);
+    cib_changed = FALSE;
+    while (!cib_changed && !expired) {
+        g_main_context_iteration(NULL, TRUE);
+    }
+
+    // Apply any other changes that have already arrived before rechecking
+    while (g_main_context_iteration(NULL, FALSE)) {
+        continue;
+    }
+    if (!expired) {
+        g_source_remove(timer);
+    }
+    watched_xml_usable = TRUE;
+}
+
 /*!
  * \internal
  * \brief Update a working set's XML input based on a CIB query
@@ -1158,11 +1278,27 @@ update_working_set_from_cib(pe_working_set_t * data_set, cib_t *cib)
     xmlNode *cib_xml_copy = NULL;
     int rc;
 
-    rc = cib->cmds->query(cib, NULL, &cib_xml_copy, cib_scope_local | cib_sync_call);
-    if (rc != pcmk_ok) {
-        fprintf(stderr, "Could not obtain the current CIB: %s (%d)\n", pcmk_strerror(rc), rc);
-        return rc;
+    /* Our own changes to the CIB might not have been applied to the local
+     * copy yet, so it can be used only right after waiting for changes.
+     */
+    if ((cib == watched_cib) && watched_xml_usable && (watched_xml != NULL)) {
+        cib_xml_copy = copy_xml(watched_xml);
+
+    } else {
+        rc = cib->cmds->query(cib, NULL, &cib_xml_copy, cib_scope_local | cib_sync_call);
+        if (rc != pcmk_ok) {
+            fprintf(stderr, "Could not obtain the current CIB: %s (%d)\n", pcmk_strerror(rc), rc);
+            return rc;
+        }
+        if (cib == watched_cib) {
+            free_xml(watched_xml);
+            watched_xml = copy_xml(cib_xml_copy);
+        }
     }
+    if (cib == watched_cib) {
+        watched_xml_usable = FALSE;
+    }
+
     rc = update_working_set_xml(data_set, &cib_xml_copy);
     if (rc != pcmk_ok) {
         fprintf(stderr, "Could not upgrade the current CIB XML\n");
@@ -1296,7 +1432,7 @@ max_delay_in(pe_working_set_t * data_set, GList *resources)
  * \param[in] rsc        The resource to restart
  * \param[in] host       The host to restart the resource on (or NULL for all)
  * \param[in] timeout_ms Consider failed if actions do not complete in this time
- *                       (specified in milliseconds, but a two-second
+ *                       (specified in milliseconds, but a one-second
  *                       granularity is actually used; if 0, a timeout will be
  *                       calculated based on the resource timeout)
  * \param[in] cib        Connection to the CIB manager
@@ -1308,11 +1444,10 @@ cli_resource_restart(pe_resource_t *rsc, const char *host, int timeout_ms,
                      cib_t *cib)
 {
     int rc = 0;
-    int lpc = 0;
     int before = 0;
-    int step_timeout_s = 0;
-    int sleep_interval = 2;
     int timeout = timeout_ms / 1000;
+    time_t expire_time = time(NULL) + timeout;
+    time_t step_end = 0;
 
     bool stop_via_ban = FALSE;
     char *rsc_id = NULL;
@@ -1423,20 +1558,20 @@ cli_resource_restart(pe_resource_t *rsc, const char *host, int timeout_ms,
     fprintf(stdout, "Waiting for %d resources to stop:\n", g_list_length(list_delta));
     display_list(list_delta, " * ");
 
-    step_timeout_s = timeout / sleep_interval;
+    watch_cib(cib);
     while (list_delta != NULL) {
         before = g_list_length(list_delta);
         if(timeout_ms == 0) {
-            step_timeout_s = max_delay_in(data_set, list_delta) / sleep_interval;
+            step_end = time(NULL) + max_delay_in(data_set, list_delta);
+        } else {
+            step_end = expire_time;
         }
 
         /* We probably don't need the entire step timeout */
-        for(lpc = 0; (lpc < step_timeout_s) && (list_delta != NULL); lpc++) {
-            sleep(sleep_interval);
-            if(timeout) {
-                timeout -= sleep_interval;
-                crm_trace("%ds remaining", timeout);
-            }
+        while ((list_delta != NULL) && (time(NULL) < step_end)) {
+            wait_for_cib_change(step_end - time(NULL));
+            crm_trace("%lds remaining", (long) (step_end - time(NULL)));
+
             rc = update_dataset(cib, data_set, FALSE);
             if(rc != pcmk_ok) {
                 fprintf(stderr, "Could not determine which resources were stopped\n");
@@ -1496,21 +1631,20 @@ cli_resource_restart(pe_resource_t *rsc, const char *host, int timeout_ms,
     fprintf(stdout, "Waiting for %d resources to start again:\n", g_list_length(list_delta));
     display_list(list_delta, " * ");
 
-    step_timeout_s = timeout / sleep_interval;
     while (waiting_for_starts(list_delta, rsc, host)) {
         before = g_list_length(list_delta);
         if(timeout_ms == 0) {
-            step_timeout_s = max_delay_in(data_set, list_delta) / sleep_interval;
+            step_end = time(NULL) + max_delay_in(data_set, list_delta);
+        } else {
+            step_end = expire_time;
         }
 
         /* We probably don't need the entire step timeout */
-        for (lpc = 0; (lpc < step_timeout_s) && waiting_for_starts(list_delta, rsc, host); lpc++) {
+        while (waiting_for_starts(list_delta, rsc, host)
+               && (time(NULL) < step_end)) {
 
-            sleep(sleep_interval);
-            if(timeout) {
-                timeout -= sleep_interval;
-                crm_trace("%ds remaining", timeout);
-            }
+            wait_for_cib_change(step_end - time(NULL));
+            crm_trace("%lds remaining", (long) (step_end - time(NULL)));
 
             rc = update_dataset(cib, data_set, FALSE);
             if(rc != pcmk_ok) {
@@ -1559,6 +1693,7 @@ cli_resource_restart(pe_resource_t *rsc, const char *host, int timeout_ms,
     }
 
 done:
+    unwatch_cib();
     if (list_delta) {
         g_list_free(list_delta);
     }
@@ -1592,25 +1727,28 @@ static inline int action_is_pending(action_t *action)
 
 /*!
  * \internal
- * \brief Return TRUE if any actions in a list are pending
+ * \brief Count the pending actions in a list
  *
  * \param[in] actions   List of actions to check
  *
- * \return TRUE if any actions in the list are pending, FALSE otherwise
+ * \return Number of actions in the list that are pending
  */
-static bool
-actions_are_pending(GListPtr actions)
+static int
+count_pending_actions(GListPtr actions)
 {
     GListPtr action;
+    int pending = 0;
 
     for (action = actions; action != NULL; action = action->next) {
         action_t *a = (action_t *)action->data;
         if (action_is_pending(a)) {
-            crm_notice("Waiting for %s (flags=0x%.8x)", a->uuid, a->flags);
-            return TRUE;
+            if (pending == 0) {
+                crm_notice("Waiting for %s (flags=0x%.8x)", a->uuid, a->flags);
+            }
+            pending++;
         }
     }
-    return FALSE;
+    return pending;
 }
 
 /*!
@@ -1643,15 +1781,12 @@ print_pending_actions(GListPtr actions)
 /* For --wait, timeout (in seconds) to use if caller doesn't specify one */
 #define WAIT_DEFAULT_TIMEOUT_S (60 * 60)
 
-/* For --wait, how long to sleep between cluster state checks */
-#define WAIT_SLEEP_S (2)
-
 /*!
  * \internal
  * \brief Wait until all pending cluster actions are complete
  *
  * This waits until either the CIB's transition graph is idle or a timeout is
- * reached.
+ * reached. Cluster state is rechecked whenever the CIB changes.
  *
  * \param[in] timeout_ms Consider failed if actions do not complete in this time
  *                       (specified in milliseconds, but one-second granularity
@@ -1664,7 +1799,9 @@ int
 wait_till_stable(int timeout_ms, cib_t * cib)
 {
     pe_working_set_t *data_set = NULL;
-    int rc = -1;
+    int rc = pcmk_ok;
+    int pending = 0;
+    int last_pending = 0;
     int timeout_s = timeout_ms? ((timeout_ms + 999) / 1000) : WAIT_DEFAULT_TIMEOUT_S;
     time_t expire_time = time(NULL) + timeout_s;
     time_t time_diff;
@@ -1677,27 +1814,14 @@ wait_till_stable(int timeout_ms, cib_t * cib)
     set_bit(data_set->flags, pe_flag_no_counts);
     set_bit(data_set->flags, pe_flag_no_compat);
 
-    do {
-
-        /* Abort if timeout is reached */
-        time_diff = expire_time - time(NULL);
-        if (time_diff > 0) {
-            crm_info("Waiting up to %ld seconds for cluster actions to complete", time_diff);
-        } else {
-            print_pending_actions(data_set->actions);
-            pe_free_working_set(data_set);
-            return -ETIME;
-        }
-        if (rc == pcmk_ok) { /* this avoids sleep on first loop iteration */
-            sleep(WAIT_SLEEP_S);
-        }
+    watch_cib(cib);
+    while (TRUE) {
 
         /* Get latest transition graph */
         pe_reset_working_set(data_set);
         rc = update_working_set_from_cib(data_set, cib);
         if (rc != pcmk_ok) {
-            pe_free_working_set(data_set);
-            return rc;
+            break;
         }
         pcmk__schedule_actions(data_set, data_set->input, NULL);
 
@@ -1720,10 +1844,31 @@ wait_till_stable(int timeout_ms, cib_t * cib)
             }
         }
 
-    } while (actions_are_pending(data_set->actions));
+        pending = count_pending_actions(data_set->actions);
+        if (pending == 0) {
+            break;
+        }
+        if ((pending != last_pending) && !BE_QUIET) {
+            printf("Waiting for %d pending action%s\n",
+                   pending, pcmk__plural_s(pending));
+            fflush(stdout);
+        }
+        last_pending = pending;
+
+        /* Abort if timeout is reached */
+        time_diff = expire_time - time(NULL);
+        if (time_diff <= 0) {
+            print_pending_actions(data_set->actions);
+            rc = -ETIME;
+            break;
+        }
+        crm_info("Waiting up to %ld seconds for cluster actions to complete", time_diff);
+        wait_for_cib_change((int) time_diff);
+    }
 
+    unwatch_cib();
     pe_free_working_set(data_set);
-    return pcmk_ok;
+    return rc;
 }
 
 int
@@ -515,6 +515,8 @@ profile_one(const char *xml_file, long long repeat, pe_working_set_t *data_set)
 {
     xmlNode *cib_object = NULL;
     clock_t start = 0;
+    unsigned long long allocs = 0;
+    unsigned long long bytes = 0;
 
     printf("* Testing %s ...", xml_file);
     fflush(stdout);
@@ -543,9 +545,11 @@ profile_one(const char *xml_file, long long repeat, pe_working_set_t *data_set)
         data_set->input = input;
         get_date(data_set, false);
         pcmk__schedule_actions(data_set, input, NULL);
+        pe__arena_stats(data_set->arena, &allocs, &bytes);
         pe_reset_working_set(data_set);
     }
-    printf(" %.2f secs\n", (clock() - start) / (float) CLOCKS_PER_SEC);
+    printf(" %.2f secs (%llu arena allocations, %llu bytes per run)\n",
+           (clock() - start) / (float) CLOCKS_PER_SEC, allocs, bytes);
 }
 
 #ifndef FILENAME_MAX